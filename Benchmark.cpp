@@ -0,0 +1,673 @@
+// Benchmark.cpp
+// Throughput of the problem generators and the solver on them. Sections are switched on and off like in Test.cpp.
+
+#include "DancingLinks.h"
+#include "ConflictIndex.h"
+#include "Langford.h"
+#include "LatinSquare.h"
+#include "Polyomino.h"
+#include "Queens.h"
+#include "Scenarios.h"
+#include "Sudoku.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+using namespace DancingLinks;
+
+#define SUDOKU 1
+#define SUDOKU_GENERATOR 1
+#define QUEENS 1
+#define COMBINATORIAL 1
+#define DELIVERY 1
+#define SCENARIOS 1
+#define NEAR 1
+#define STRATEGIES 1
+#define SET_COVER 1
+#define UNDO 1
+#define PARALLEL 1
+#define CONFLICT_INDEX 1
+
+static double Seconds(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Count the solutions of a matrix in callback mode and compare with the known count
+static void CountAndCheck(const char* name, SparseMatrix* dlx, uint64_t expected)
+{
+    auto start = chrono::steady_clock::now();
+    uint64_t count = 0;
+    dlx->Solve([](int) {}, [](int) {}, [&count]() { ++count; });
+    double time = Seconds(start);
+    printf("%s: %llu solutions in %.3fs, %.0f nodes/s%s\n\r", name, (unsigned long long)count, time,
+        dlx->Metrics().nodes / time, count == expected ? "" : " (WRONG)");
+}
+
+int main()
+{
+#if SUDOKU
+    // Sudoku of growing size and the variants. For each one a full grid is found first (the first solution of the
+    // empty grid), then puzzles are made from it by relabeling the digits and keeping a random part of the cells
+    // (larger grids get more clues, with half the cells given a 25x25 puzzle can take seconds).
+    // Each puzzle is built, solved to the first solution and destroyed, the time is split between building (the
+    // matrix and the givens) and solving.
+    {
+        struct Case
+        {
+            const char* name;
+            SudokuProblem problem;
+            int puzzles;
+            double clues; // fraction of the cells given
+        };
+        Case cases[] = {
+            { "9x9", MakeSudoku(3, 3), 2000, 0.5 },
+            { "9x9 diagonal", MakeSudoku(3, 3, true), 2000, 0.5 },
+            { "9x9 jigsaw", MakeJigsawSudoku({
+                "AAABBBCCC",
+                "AABBBBCCC",
+                "AAAABBCCC",
+                "DDDEEEFFF",
+                "DDEEEFFFF",
+                "DDDDEEEFF",
+                "GGGHHHIII",
+                "GGGHHHIII",
+                "GGGHHHIII" }), 2000, 0.5 },
+            { "16x16", MakeSudoku(4, 4), 200, 0.5 },
+            { "25x25", MakeSudoku(5, 5), 20, 0.6 },
+            { "36x36", MakeSudoku(6, 6), 5, 0.65 },
+        };
+
+        mt19937 random(2024);
+        for (auto& test : cases)
+        {
+            const SudokuProblem& sudoku = test.problem;
+            int cells = sudoku.size * sudoku.size;
+
+            auto start = chrono::steady_clock::now();
+            SparseMatrix* dlx = SparseMatrix::Create();
+            BuildMatrix(sudoku, dlx);
+            vector<int> full(cells, 0);
+            for (auto& s : dlx->Solve())
+            {
+                full = DecodeSolution(sudoku, full, s);
+                break;
+            }
+            SparseMatrix::Destroy(dlx);
+            double fillTime = Seconds(start);
+            if (full[0] == 0)
+            {
+                printf("%s: no solution\n\r", test.name);
+                continue;
+            }
+
+            vector<vector<int>> puzzles;
+            for (int i = 0; i < test.puzzles; ++i)
+            {
+                vector<int> digits(sudoku.size);
+                iota(digits.begin(), digits.end(), 1);
+                shuffle(digits.begin(), digits.end(), random);
+                vector<int> puzzle(cells);
+                for (int cell = 0; cell < cells; ++cell)
+                    puzzle[cell] = uniform_real_distribution<>()(random) < test.clues ? digits[full[cell] - 1] : 0;
+                puzzles.push_back(puzzle);
+            }
+
+            double buildTime = 0, solveTime = 0;
+            int solved = 0;
+            for (auto& puzzle : puzzles)
+            {
+                start = chrono::steady_clock::now();
+                dlx = SparseMatrix::Create();
+                BuildMatrix(sudoku, dlx);
+                SetGivens(sudoku, puzzle, dlx);
+                buildTime += Seconds(start);
+
+                start = chrono::steady_clock::now();
+                solved += (int)dlx->Count(1);
+                SparseMatrix::Destroy(dlx);
+                solveTime += Seconds(start);
+            }
+
+            printf("%s: full grid in %.3fs, %d/%d puzzles solved, %.1f puzzles/s (build %.3fms, solve %.3fms each)\n\r",
+                test.name, fillTime, solved, test.puzzles, test.puzzles / (buildTime + solveTime),
+                1000 * buildTime / test.puzzles, 1000 * solveTime / test.puzzles);
+        }
+    }
+#endif
+
+#if SUDOKU_GENERATOR
+    // Minimal unique puzzles, first any difficulty, then only those taking at least twice the average number
+    // of search nodes to solve (the rest are thrown away, so the rate drops). Runs on all cores.
+    {
+        struct Case
+        {
+            const char* name;
+            SudokuProblem problem;
+            int puzzles;
+            bool hard;
+        };
+        Case cases[] = {
+            { "9x9", MakeSudoku(3, 3), 1000, true },
+            { "9x9 diagonal", MakeSudoku(3, 3, true), 500, true },
+            { "16x16", MakeSudoku(4, 4), 5, false }, // seconds per puzzle, most of it proving the last clues necessary
+        };
+
+        for (auto& test : cases)
+        {
+            SudokuGeneratorOptions options;
+            for (int pass = 0; pass < (test.hard ? 2 : 1); ++pass)
+            {
+                auto start = chrono::steady_clock::now();
+                auto puzzles = GeneratePuzzles(test.problem, test.puzzles, options);
+                double time = Seconds(start);
+                if (puzzles.empty())
+                {
+                    printf("%s generator%s: no puzzle in the difficulty window\n\r", test.name, pass ? " (hard)" : "");
+                    break;
+                }
+
+                double clues = 0, nodes = 0;
+                for (auto& puzzle : puzzles)
+                {
+                    clues += count_if(puzzle.givens.begin(), puzzle.givens.end(), [](int n) { return n > 0; });
+                    nodes += puzzle.nodes;
+                }
+                clues /= puzzles.size();
+                nodes /= puzzles.size();
+
+                printf("%s generator%s: %.1f puzzles/s, %.1f clues and %.0f nodes on average\n\r", test.name,
+                    pass ? " (hard)" : "", puzzles.size() / time, clues, nodes);
+                options.minNodes = uint64_t(2 * nodes);
+            }
+        }
+    }
+#endif
+
+#if QUEENS
+    // N queens counts checked against the known values (OEIS A000170). Raise MAX_QUEENS for the larger boards,
+    // every step is several times slower than the previous one.
+    {
+        constexpr int MAX_QUEENS = 14;
+        static const uint64_t known[] = { 1, 0, 0, 2, 10, 4, 40, 92, 352, 724, 2680, 14200, 73712, 365596, 2279184,
+            14772512, 95815104, 666090624, 4968057848ull, 39029188884ull };
+
+        for (int n = 1; n <= MAX_QUEENS; ++n)
+        {
+            auto start = chrono::steady_clock::now();
+            uint64_t count = CountQueens(n);
+            double time = Seconds(start);
+            bool wrong = n <= int(sizeof(known) / sizeof(known[0])) && count != known[n - 1];
+            printf("%d queens: %llu solutions in %.3fs%s\n\r", n, (unsigned long long)count, time, wrong ? " (WRONG)" : "");
+        }
+    }
+#endif
+
+#if COMBINATORIAL
+    // A mix of classic problems, each counted with the expected value known
+    {
+        auto check = [](const char* name, const ExactCoverProblem& problem, uint64_t expected)
+            {
+                SparseMatrix* dlx = SparseMatrix::Create();
+                if (BuildMatrix(problem, dlx))
+                    CountAndCheck(name, dlx, expected);
+                SparseMatrix::Destroy(dlx);
+            };
+
+        check("Langford pairs, n = 12", MakeLangford(12, true), 108144);
+        check("Latin squares of order 5", MakeLatinSquares(5), 161280);
+        check("Transversals of the cyclic square of order 9", MakeTransversals(CyclicLatinSquare(9)), 2025);
+
+        // Orthogonal mates from all the transversals: 635 partitions, each good for 7! mates
+        {
+            auto square = CyclicLatinSquare(7);
+            vector<vector<int>> transversals;
+            SparseMatrix* dlx = SparseMatrix::Create();
+            BuildMatrix(MakeTransversals(square), dlx);
+            for (auto& s : dlx->Solve())
+                transversals.push_back(s);
+            SparseMatrix::Destroy(dlx);
+            check("Orthogonal mates of the cyclic square of order 7", MakeOrthogonalMates(square, transversals), 635);
+        }
+
+        // Strips of dominoes (any number of them) and of the twelve pentominoes
+        struct Strip
+        {
+            const char* name;
+            vector<Polyomino> pieces;
+            int width, height;
+            uint64_t expected;
+        };
+        Strip strips[] = {
+            { "Domino tilings of 2x20", { MakePolyomino('D', { "XX" }, false) }, 20, 2, 10946 },
+            { "Domino tilings of 4x10", { MakePolyomino('D', { "XX" }, false) }, 10, 4, 18061 },
+            { "Pentomino tilings of 3x20", Pentominoes(), 20, 3, 8 },
+            { "Pentomino tilings of 4x15", Pentominoes(), 15, 4, 1472 },
+            { "Pentomino tilings of 5x12", Pentominoes(), 12, 5, 4040 },
+        };
+        for (auto& strip : strips)
+        {
+            PolyominoBoard board;
+            board.width = strip.width;
+            board.height = strip.height;
+            SparseMatrix* dlx = SparseMatrix::Create();
+            BuildMatrix(GeneratePlacements(strip.pieces, board), dlx);
+            CountAndCheck(strip.name, dlx, strip.expected);
+            SparseMatrix::Destroy(dlx);
+        }
+    }
+#endif
+
+#if DELIVERY
+    // The three ways of getting solutions out on a problem with many short ones (Latin squares of order 5). The
+    // checksum is there so that the solutions are actually looked at.
+    {
+        ExactCoverProblem problem = MakeLatinSquares(5);
+        auto run = [&problem](const char* name, auto solve)
+            {
+                SparseMatrix* dlx = SparseMatrix::Create();
+                BuildMatrix(problem, dlx);
+                auto start = chrono::steady_clock::now();
+                uint64_t count = 0, checksum = 0;
+                solve(dlx, count, checksum);
+                double time = Seconds(start);
+                SparseMatrix::Destroy(dlx);
+                printf("%s: %llu solutions (checksum %llu) in %.3fs\n\r", name, (unsigned long long)count,
+                    (unsigned long long)checksum, time);
+            };
+
+        run("Generator", [](SparseMatrix* dlx, uint64_t& count, uint64_t& checksum)
+            {
+                for (auto& s : dlx->Solve())
+                {
+                    ++count;
+                    for (int r : s)
+                        checksum += r;
+                }
+            });
+        run("Callbacks", [](SparseMatrix* dlx, uint64_t& count, uint64_t& checksum)
+            {
+                uint64_t sum = 0;
+                dlx->Solve([&sum](int r) { sum += r; }, [&sum](int r) { sum -= r; },
+                    [&]() { ++count; checksum += sum; });
+            });
+        run("Blocks", [](SparseMatrix* dlx, uint64_t& count, uint64_t& checksum)
+            {
+                dlx->SolveBlocks([&](const SolutionBlock& block)
+                    {
+                        count += block.Count();
+                        for (int r : block.rows)
+                            checksum += r;
+                    });
+            });
+    }
+#endif
+
+#if SCENARIOS
+    // What-if sweeps on one thread and on all cores. Sudoku hints: for minimal puzzles every candidate of every
+    // empty cell is forced in turn (only the solution digit is feasible) and every solution digit excluded (never
+    // feasible), each checked for one solution. Queens: two queens placed on the first two ranks in every way and
+    // all solutions counted (adding up to the total).
+    {
+        auto sweep = [](const char* name, const SparseMatrix* base, const vector<Scenario>& scenarios,
+            const ScenarioOptions& options, auto check)
+            {
+                for (int threads : { 1, 0 })
+                {
+                    ScenarioOptions run = options;
+                    run.threads = threads;
+                    auto start = chrono::steady_clock::now();
+                    auto results = SolveScenarios(base, scenarios, run);
+                    double time = Seconds(start);
+                    printf("%s: %zu scenarios on %s, %.0f scenarios/s%s\n\r", name, scenarios.size(),
+                        threads == 1 ? "one thread" : "all cores", scenarios.size() / time, check(results) ? "" : " (WRONG)");
+                }
+            };
+
+        SudokuProblem sudoku = MakeSudoku(3, 3);
+        for (auto& puzzle : GeneratePuzzles(sudoku, 5))
+        {
+            SparseMatrix* dlx = SparseMatrix::Create();
+            BuildMatrix(sudoku, dlx);
+            SetGivens(sudoku, puzzle.givens, dlx);
+
+            vector<Scenario> scenarios;
+            size_t empty = 0;
+            for (int cell = 0; cell < sudoku.size * sudoku.size; ++cell)
+            {
+                if (puzzle.givens[cell] > 0)
+                    continue;
+                ++empty;
+                int row = cell / sudoku.size, col = cell % sudoku.size;
+                for (int n = 1; n <= sudoku.size; ++n)
+                    scenarios.push_back({ { SudokuRow(sudoku, row, col, n) }, {} });
+                scenarios.push_back({ {}, { SudokuRow(sudoku, row, col, puzzle.solution[cell]) } });
+            }
+
+            ScenarioOptions options;
+            options.limit = 1;
+            sweep("9x9 hints", dlx, scenarios, options, [empty](const vector<ScenarioResult>& results)
+                {
+                    return (size_t)count_if(results.begin(), results.end(), [](auto& result) { return result.count > 0; }) == empty;
+                });
+            SparseMatrix::Destroy(dlx);
+        }
+
+        constexpr int N = 12;
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildQueensMatrix(N, dlx);
+        vector<Scenario> scenarios;
+        for (int first = 0; first < N; ++first)
+            for (int second = 0; second < N; ++second)
+                scenarios.push_back({ { first * N, second * N + 1 }, {} });
+        sweep("12 queens, first two ranks", dlx, scenarios, {}, [](const vector<ScenarioResult>& results)
+            {
+                uint64_t total = 0;
+                for (auto& result : results)
+                    total += result.count;
+                return total == 14200;
+            });
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if NEAR
+    // Re-solving after an edit: every row of a solution is excluded in turn and a new solution looked for from
+    // scratch and with SolveNear starting from the old one. Shown per edit: time, search nodes and how many rows of
+    // the new solution were not in the old one.
+    {
+        auto edits = [](const char* name, SparseMatrix* dlx)
+            {
+                vector<int> previous;
+                dlx->Count(1, &previous);
+
+                double coldTime = 0, nearTime = 0, coldNodes = 0, nearNodes = 0, coldChanged = 0, nearChanged = 0;
+                bool wrong = false;
+                auto changed = [&previous](const vector<int>& solution)
+                    {
+                        return count_if(solution.begin(), solution.end(),
+                            [&previous](int r) { return find(previous.begin(), previous.end(), r) == previous.end(); });
+                    };
+                for (int r : previous)
+                {
+                    dlx->ExcludeRow(r);
+
+                    vector<int> cold, near;
+                    uint64_t nodes = dlx->Metrics().nodes;
+                    auto start = chrono::steady_clock::now();
+                    bool coldFound = dlx->Count(1, &cold) > 0;
+                    coldTime += Seconds(start);
+                    coldNodes += dlx->Metrics().nodes - nodes;
+                    coldChanged += changed(cold);
+
+                    nodes = dlx->Metrics().nodes;
+                    start = chrono::steady_clock::now();
+                    bool nearFound = dlx->SolveNear(previous, near);
+                    nearTime += Seconds(start);
+                    nearNodes += dlx->Metrics().nodes - nodes;
+                    nearChanged += changed(near);
+
+                    wrong = wrong || coldFound != nearFound;
+                    dlx->RestoreRow(r);
+                }
+
+                size_t n = previous.size();
+                printf("%s: %zu edits, cold %.3fms %.0f nodes %.1f rows changed, near %.3fms %.0f nodes %.1f rows changed%s\n\r",
+                    name, n, 1000 * coldTime / n, coldNodes / n, coldChanged / n, 1000 * nearTime / n, nearNodes / n,
+                    nearChanged / n, wrong ? " (WRONG)" : "");
+            };
+
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(MakeLangford(20, false), dlx);
+        edits("Langford pairs, n = 20", dlx);
+        SparseMatrix::Destroy(dlx);
+
+        PolyominoBoard board;
+        board.width = 12;
+        board.height = 5;
+        dlx = SparseMatrix::Create();
+        BuildMatrix(GeneratePlacements(Pentominoes(), board), dlx);
+        edits("Pentominoes 5x12", dlx);
+        SparseMatrix::Destroy(dlx);
+
+        SudokuProblem sudoku = MakeSudoku(5, 5);
+        dlx = SparseMatrix::Create();
+        BuildMatrix(sudoku, dlx);
+        edits("Sudoku 25x25 grid", dlx);
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if STRATEGIES
+    // Find-first strategies on 25x25 Sudoku with half the cells given, where plain depth first search has a heavy
+    // tail: most puzzles take milliseconds, a few take seconds after an early wrong choice. Default options, all
+    // three strategies are complete and solve every puzzle; what differs is the time.
+    {
+        SudokuProblem sudoku = MakeSudoku(5, 5);
+        int cells = sudoku.size * sudoku.size;
+        constexpr int PUZZLES = 6;
+
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(sudoku, dlx);
+        vector<int> solution;
+        dlx->Count(1, &solution);
+        SparseMatrix::Destroy(dlx);
+        vector<int> full = DecodeSolution(sudoku, vector<int>(cells, 0), solution);
+
+        mt19937 random(5);
+        vector<vector<int>> puzzles;
+        for (int i = 0; i < PUZZLES; ++i)
+        {
+            vector<int> digits(sudoku.size);
+            iota(digits.begin(), digits.end(), 1);
+            shuffle(digits.begin(), digits.end(), random);
+            vector<int> puzzle(cells);
+            for (int cell = 0; cell < cells; ++cell)
+                puzzle[cell] = uniform_real_distribution<>()(random) < 0.5 ? digits[full[cell] - 1] : 0;
+            puzzles.push_back(puzzle);
+        }
+
+        const pair<const char*, SearchOptions::Strategy> strategies[] = {
+            { "depth first", SearchOptions::depthFirst },
+            { "limited discrepancy", SearchOptions::discrepancy },
+            { "beam", SearchOptions::beam },
+        };
+        for (auto& strategy : strategies)
+        {
+            SearchOptions search;
+            search.strategy = strategy.second;
+            double total = 0, worst = 0;
+            int solved = 0;
+            for (auto& puzzle : puzzles)
+            {
+                dlx = SparseMatrix::Create();
+                BuildMatrix(sudoku, dlx);
+                SetGivens(sudoku, puzzle, dlx);
+                auto start = chrono::steady_clock::now();
+                solved += dlx->SolveFirst(solution, search);
+                double time = Seconds(start);
+                SparseMatrix::Destroy(dlx);
+                total += time;
+                worst = max(worst, time);
+            }
+            printf("25x25 Sudoku, %s: %d/%d solved in %.3fs, worst %.3fs\n\r", strategy.first, solved, PUZZLES, total, worst);
+        }
+    }
+#endif
+
+#if SET_COVER
+    // Minimum set cover: fewest queens attacking or occupying every square of an n x n board (OEIS A075458)
+    {
+        constexpr int MAX_BOARD = 11;
+        static const int known[] = { 1, 1, 1, 2, 3, 3, 4, 5, 5, 5, 5, 6, 7, 8, 9 };
+
+        for (int n = 4; n <= MAX_BOARD; ++n)
+        {
+            SparseMatrix* dlx = SparseMatrix::Create();
+            dlx->BuildRows(n * n, [n](int r, vector<int>& columns)
+                {
+                    int x = r % n, y = r / n;
+                    for (int c = 0; c < n * n; ++c)
+                    {
+                        int u = c % n, v = c / n;
+                        if (u == x || v == y || u - v == x - y || u + v == x + y)
+                            columns.push_back(c);
+                    }
+                });
+            for (int c = 0; c < n * n; ++c)
+                dlx->SetConditionAtLeastOnce(c);
+
+            auto start = chrono::steady_clock::now();
+            vector<int> queens;
+            dlx->SolveMinimum(queens);
+            double time = Seconds(start);
+            printf("Queen domination of %dx%d: %zu queens in %.3fs, %llu nodes%s\n\r", n, n, queens.size(), time,
+                (unsigned long long)dlx->Metrics().nodes, (int)queens.size() == known[n - 1] ? "" : " (WRONG)");
+            SparseMatrix::Destroy(dlx);
+        }
+    }
+#endif
+
+#if UNDO
+    // The two ways of restoring hidden columns (see UndoMode) counting the same problems. Both visit the same
+    // nodes, only the time of undoing differs.
+    {
+        auto compare = [](const char* name, auto build)
+            {
+                double times[2];
+                uint64_t counts[2];
+                for (int m = 0; m < 2; ++m)
+                {
+                    SparseMatrix* dlx = SparseMatrix::Create();
+                    build(dlx);
+                    dlx->SetUndoMode(m == 0 ? UndoMode::relink : UndoMode::trail);
+                    auto start = chrono::steady_clock::now();
+                    counts[m] = dlx->Count();
+                    times[m] = Seconds(start);
+                    SparseMatrix::Destroy(dlx);
+                }
+                printf("%s: relink %.3fs, trail %.3fs (%+.0f%%)%s\n\r", name, times[0], times[1],
+                    100.0 * (times[1] - times[0]) / times[0], counts[0] == counts[1] ? "" : " (WRONG)");
+            };
+
+        compare("Langford pairs, n = 12", [](SparseMatrix* dlx) { BuildMatrix(MakeLangford(12, true), dlx); });
+        compare("Latin squares of order 5", [](SparseMatrix* dlx) { BuildMatrix(MakeLatinSquares(5), dlx); });
+        compare("13 queens", [](SparseMatrix* dlx) { BuildQueensMatrix(13, dlx); });
+        compare("Pentomino tilings of 5x12", [](SparseMatrix* dlx)
+            {
+                PolyominoBoard board;
+                board.width = 12;
+                board.height = 5;
+                BuildMatrix(GeneratePlacements(Pentominoes(), board), dlx);
+            });
+    }
+#endif
+
+#if PARALLEL
+    // Enumeration on all cores with the solutions still in the sequential order. Both runs fold the solutions into
+    // an order dependent hash to confirm they match.
+    {
+        auto compare = [](const char* name, SparseMatrix* dlx)
+            {
+                uint64_t hashes[2] = { 0, 0 };
+                double times[2];
+                for (int m = 0; m < 2; ++m)
+                {
+                    uint64_t& hash = hashes[m];
+                    auto consume = [&hash](const SolutionBlock& block)
+                        {
+                            for (int r : block.rows)
+                                hash = hash * 1099511628211ull + uint64_t(r) + 1;
+                        };
+                    auto start = chrono::steady_clock::now();
+                    if (m == 0)
+                        dlx->SolveBlocks(consume);
+                    else
+                        dlx->SolveParallel(consume);
+                    times[m] = Seconds(start);
+                }
+                printf("%s: sequential %.3fs, %u threads %.3fs%s\n\r", name, times[0], thread::hardware_concurrency(),
+                    times[1], hashes[0] == hashes[1] ? "" : " (WRONG ORDER)");
+            };
+
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildQueensMatrix(14, dlx);
+        compare("14 queens", dlx);
+        SparseMatrix::Destroy(dlx);
+
+        dlx = SparseMatrix::Create();
+        BuildMatrix(MakeLangford(12, true), dlx);
+        compare("Langford pairs, n = 12", dlx);
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if CONFLICT_INDEX
+    // Rows still available next to a partial 25x25 Sudoku grid (a random half of a full one), found by the index and
+    // by preselecting the rows and checking every row's columns against those taken
+    {
+        constexpr int QUERIES = 100;
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(MakeSudoku(5, 5), dlx);
+        vector<int> grid;
+        dlx->Count(1, &grid);
+
+        auto start = chrono::steady_clock::now();
+        ConflictIndex* index = ConflictIndex::Create(dlx);
+        double buildTime = Seconds(start);
+
+        mt19937 random(1);
+        double indexTime = 0, directTime = 0;
+        size_t available = 0;
+        bool wrong = false;
+        vector<int> rows, direct, columns;
+        vector<char> taken;
+        for (int q = 0; q < QUERIES; ++q)
+        {
+            vector<int> selection = grid;
+            shuffle(selection.begin(), selection.end(), random);
+            selection.resize(selection.size() / 2);
+
+            start = chrono::steady_clock::now();
+            index->CompatibleRows(selection, rows);
+            indexTime += Seconds(start);
+
+            start = chrono::steady_clock::now();
+            dlx->PreselectRows(selection);
+            taken.assign(4 * 25 * 25, 0);
+            for (int r : selection)
+            {
+                dlx->RowColumns(r, columns);
+                for (int c : columns)
+                    taken[c] = 1;
+            }
+            direct.clear();
+            for (int r = 0; r < dlx->RowCount(); ++r)
+            {
+                dlx->RowColumns(r, columns);
+                if (!columns.empty() && none_of(columns.begin(), columns.end(), [&taken](int c) { return taken[c] != 0; }))
+                    direct.push_back(r);
+            }
+            while (!dlx->SelectedRows().empty())
+                dlx->UnselectRow(dlx->SelectedRows().back());
+            directTime += Seconds(start);
+
+            available += rows.size();
+            wrong = wrong || rows != direct;
+        }
+        printf("25x25 Sudoku conflict index: built in %.3fs (%.1f MB), %.0f rows available on average, %.1fus per query, "
+            "%.1fus preselecting%s\n\r", buildTime, index->MemoryBytes() / 1048576.0, double(available) / QUERIES,
+            indexTime * 1e6 / QUERIES, directTime * 1e6 / QUERIES, wrong ? " (WRONG)" : "");
+
+        ConflictIndex::Destroy(index);
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Bitboard.h
+// Fixed size bit sets for placement generators
+
+#pragma once
+
+#include <cstdint>
+#include <bit>
+
+namespace DancingLinks
+{
+    // A board of up to 64 * Words cells. Shapes are stored at the origin and moved around by shifting, which
+    // is what makes the placement generators fast: a placement test is a shift and an AND per word.
+    template<int Words>
+    struct Bitboard
+    {
+        static constexpr int capacity = 64 * Words;
+
+        uint64_t bits[Words] = {};
+
+        void Set(int i)
+        {
+            bits[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+
+        bool Test(int i) const
+        {
+            return (bits[i >> 6] >> (i & 63)) & 1;
+        }
+
+        bool Empty() const
+        {
+            uint64_t any = 0;
+            for (int w = 0; w < Words; ++w)
+                any |= bits[w];
+            return any == 0;
+        }
+
+        // Nothing set outside the mask
+        bool Inside(const Bitboard& mask) const
+        {
+            uint64_t outside = 0;
+            for (int w = 0; w < Words; ++w)
+                outside |= bits[w] & ~mask.bits[w];
+            return outside == 0;
+        }
+
+        Bitboard operator<<(int n) const
+        {
+            Bitboard result;
+            int words = n >> 6, shift = n & 63;
+            for (int w = Words - 1; w >= words; --w)
+            {
+                result.bits[w] = bits[w - words] << shift;
+                if (shift && w > words)
+                    result.bits[w] |= bits[w - words - 1] >> (64 - shift);
+            }
+            return result;
+        }
+
+        bool operator<(const Bitboard& other) const
+        {
+            for (int w = Words - 1; w >= 0; --w)
+                if (bits[w] != other.bits[w])
+                    return bits[w] < other.bits[w];
+            return false;
+        }
+
+        bool operator==(const Bitboard& other) const
+        {
+            for (int w = 0; w < Words; ++w)
+                if (bits[w] != other.bits[w])
+                    return false;
+            return true;
+        }
+
+        // Call f(index) for every set bit in increasing order
+        template<typename F> void ForEach(F f) const
+        {
+            for (int w = 0; w < Words; ++w)
+                for (uint64_t b = bits[w]; b; b &= b - 1)
+                    f(w * 64 + std::countr_zero(b));
+        }
+    };
+}
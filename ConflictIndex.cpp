@@ -0,0 +1,213 @@
+// ConflictIndex.cpp
+// Precomputed row conflicts, one compressed bit set per row
+
+#include <assert.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <bit>
+
+#include "ConflictIndex.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    class ConflictIndexImp final : public ConflictIndex
+    {
+    private:
+        int mRowCount = 0;
+        // Rows with at least one column, the starting point of every query
+        std::vector<uint64_t> mValid;
+        // Conflict set of row r: the words mBits[mStart[r], mStart[r + 1]) at positions mWord[...], positions
+        // ascending, zero words left out
+        std::vector<size_t> mStart;
+        std::vector<uint32_t> mWord;
+        std::vector<uint64_t> mBits;
+
+    public:
+        ConflictIndexImp(const SparseMatrix* dlx, int threads);
+
+        virtual int RowCount() const override;
+        virtual bool Conflicts(int a, int b) const override;
+        virtual void CompatibleRows(std::span<const int> selection, std::vector<int>& rows) const override;
+        virtual void CompatibleRows(std::span<const int> selection, std::vector<uint64_t>& bits) const override;
+        virtual size_t MemoryBytes() const override;
+    };
+
+    ConflictIndex* ConflictIndex::Create(const SparseMatrix* dlx, int threads)
+    {
+        return new ConflictIndexImp(dlx, threads);
+    }
+
+    void ConflictIndex::Destroy(ConflictIndex* ptr)
+    {
+        delete ptr;
+    }
+
+    ConflictIndexImp::ConflictIndexImp(const SparseMatrix* dlx, int threads)
+    {
+        assert(dlx != nullptr);
+        mRowCount = dlx->RowCount();
+        size_t words = (size_t(mRowCount) + 63) / 64;
+        mValid.assign(words, 0);
+
+        // The columns of every row that can be taken only once and, turned around, the rows of every such column
+        // (ascending as rows are read in order)
+        vector<size_t> rowStart(1, 0);
+        vector<int> rowColumns;
+        vector<int> columns;
+        int columnCount = 0;
+        for (int r = 0; r < mRowCount; ++r)
+        {
+            dlx->RowColumns(r, columns);
+            if (!columns.empty())
+                mValid[r >> 6] |= uint64_t(1) << (r & 63);
+            for (int c : columns)
+            {
+                ColumnKind kind = dlx->ColumnKindOf(c);
+                if (kind == ColumnKind::exact || kind == ColumnKind::optional)
+                {
+                    rowColumns.push_back(c);
+                    columnCount = max(columnCount, c + 1);
+                }
+            }
+            rowStart.push_back(rowColumns.size());
+        }
+
+        vector<size_t> columnStart(columnCount + 1, 0);
+        for (int c : rowColumns)
+            ++columnStart[c + 1];
+        for (int c = 0; c < columnCount; ++c)
+            columnStart[c + 1] += columnStart[c];
+        vector<int> columnRows(rowColumns.size());
+        vector<size_t> fill(columnStart.begin(), columnStart.end() - 1);
+        for (int r = 0; r < mRowCount; ++r)
+            for (size_t k = rowStart[r]; k < rowStart[r + 1]; ++k)
+                columnRows[fill[rowColumns[k]]++] = r;
+
+        // Rows go in chunks to the threads. Each thread ORs the column lists of a row into a dense scratch set
+        // (with the row itself, which may have shared columns only), remembering which words it touched, and
+        // appends those words in order to the chunk.
+        constexpr int chunkRows = 1024;
+        struct Chunk
+        {
+            vector<size_t> sizes;
+            vector<uint32_t> word;
+            vector<uint64_t> bits;
+        };
+        vector<Chunk> chunks((mRowCount + chunkRows - 1) / chunkRows);
+
+        if (threads <= 0)
+            threads = max(1, (int)thread::hardware_concurrency());
+        threads = max(1, min(threads, (int)chunks.size()));
+
+        atomic<size_t> next{ 0 };
+        auto work = [&]()
+            {
+                vector<uint64_t> scratch(words, 0);
+                vector<uint32_t> touched;
+                for (size_t k; (k = next++) < chunks.size(); )
+                {
+                    Chunk& chunk = chunks[k];
+                    int last = min(mRowCount, int(k + 1) * chunkRows);
+                    for (int r = int(k) * chunkRows; r < last; ++r)
+                    {
+                        if (mValid[r >> 6] >> (r & 63) & 1)
+                        {
+                            touched.push_back(uint32_t(r >> 6));
+                            scratch[r >> 6] = uint64_t(1) << (r & 63);
+                        }
+                        for (size_t i = rowStart[r]; i < rowStart[r + 1]; ++i)
+                        {
+                            int c = rowColumns[i];
+                            for (size_t j = columnStart[c]; j < columnStart[c + 1]; ++j)
+                            {
+                                int s = columnRows[j];
+                                uint32_t w = uint32_t(s >> 6);
+                                if (scratch[w] == 0)
+                                    touched.push_back(w);
+                                scratch[w] |= uint64_t(1) << (s & 63);
+                            }
+                        }
+
+                        sort(touched.begin(), touched.end());
+                        for (uint32_t w : touched)
+                        {
+                            chunk.word.push_back(w);
+                            chunk.bits.push_back(scratch[w]);
+                            scratch[w] = 0;
+                        }
+                        chunk.sizes.push_back(touched.size());
+                        touched.clear();
+                    }
+                }
+            };
+
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t)
+            pool.emplace_back(work);
+        work();
+        for (auto& th : pool)
+            th.join();
+
+        size_t total = 0;
+        for (auto& chunk : chunks)
+            total += chunk.word.size();
+        mStart.reserve(size_t(mRowCount) + 1);
+        mStart.push_back(0);
+        mWord.reserve(total);
+        mBits.reserve(total);
+        for (auto& chunk : chunks)
+        {
+            for (size_t size : chunk.sizes)
+                mStart.push_back(mStart.back() + size);
+            mWord.insert(mWord.end(), chunk.word.begin(), chunk.word.end());
+            mBits.insert(mBits.end(), chunk.bits.begin(), chunk.bits.end());
+        }
+    }
+
+    int ConflictIndexImp::RowCount() const
+    {
+        return mRowCount;
+    }
+
+    bool ConflictIndexImp::Conflicts(int a, int b) const
+    {
+        assert(a >= 0 && a < mRowCount && b >= 0 && b < mRowCount);
+
+        auto first = mWord.begin() + mStart[a];
+        auto last = mWord.begin() + mStart[a + 1];
+        auto it = lower_bound(first, last, uint32_t(b >> 6));
+        return it != last && *it == uint32_t(b >> 6) && ((mBits[it - mWord.begin()] >> (b & 63)) & 1);
+    }
+
+    void ConflictIndexImp::CompatibleRows(span<const int> selection, vector<uint64_t>& bits) const
+    {
+        bits = mValid;
+        for (int r : selection)
+        {
+            assert(r >= 0 && r < mRowCount);
+            for (size_t k = mStart[r]; k < mStart[r + 1]; ++k)
+                bits[mWord[k]] &= ~mBits[k];
+        }
+    }
+
+    void ConflictIndexImp::CompatibleRows(span<const int> selection, vector<int>& rows) const
+    {
+        vector<uint64_t> bits;
+        CompatibleRows(selection, bits);
+
+        rows.clear();
+        for (size_t w = 0; w < bits.size(); ++w)
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1)
+                rows.push_back(int(w * 64) + countr_zero(word));
+    }
+
+    size_t ConflictIndexImp::MemoryBytes() const
+    {
+        return sizeof(ConflictIndexImp) + mValid.capacity() * sizeof(uint64_t) + mStart.capacity() * sizeof(size_t) +
+            mWord.capacity() * sizeof(uint32_t) + mBits.capacity() * sizeof(uint64_t);
+    }
+}
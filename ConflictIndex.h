@@ -0,0 +1,46 @@
+// ConflictIndex.h
+// Precomputed row conflicts for quick partial solution queries
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+#include "DancingLinks.h"
+
+namespace DancingLinks
+{
+    // For every row of a matrix the set of rows sharing a column with it, as a bit set over the rows. Only the
+    // non-zero 64-bit words are stored (with their positions), in a typical matrix a row conflicts with few others.
+    // Which rows fit together with a partial solution is then a matter of clearing the conflict sets of its rows
+    // from one bit set, instead of preselecting them and walking the columns. The index is a snapshot of the rows,
+    // preselections and exclusions of the matrix are not part of it. At-least-once and capacity columns can be
+    // shared, so they make no conflicts; whether more rows than its capacity use one is not checked here.
+    class ConflictIndex
+    {
+    protected:
+        virtual ~ConflictIndex() = default;
+
+    public:
+        // The sets are built on several threads (threads <= 0 means one per core). The matrix is only read and
+        // can be destroyed afterwards.
+        static ConflictIndex* Create(const SparseMatrix* dlx, int threads = 0);
+        static void Destroy(ConflictIndex* ptr);
+
+        virtual int RowCount() const = 0;
+
+        // Rows a and b share a column (every row with columns conflicts with itself)
+        virtual bool Conflicts(int a, int b) const = 0;
+
+        // Rows sharing no column with any of the selected rows, in ascending order. The selected rows themselves
+        // are not listed, neither are rows without columns. The selection is not checked for conflicts within.
+        virtual void CompatibleRows(std::span<const int> selection, std::vector<int>& rows) const = 0;
+        // The same as a bit set, row r is bit r % 64 of word r / 64
+        virtual void CompatibleRows(std::span<const int> selection, std::vector<uint64_t>& bits) const = 0;
+
+        // Memory held by the sets
+        virtual size_t MemoryBytes() const = 0;
+    };
+}
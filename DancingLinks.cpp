@@ -7,6 +7,15 @@
 #include <assert.h>
 #include <vector>
 #include <limits>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <span>
+#include <algorithm>
+#include <cmath>
 #include <experimental/generator>
 
 #include "DancingLinks.h"
@@ -90,6 +99,21 @@ namespace DancingLinks
             return link[dir];
         }
 
+        // Raw link assignment, only used when the matrix is built in bulk
+        template<int dir> void Link(SetCell* target)
+        {
+            link[dir] = target;
+        }
+
+        // Copy of another cell with the links translated by map, only used when the matrix is cloned
+        template<typename Map> void CopyFrom(const SetCell& other, Map& map)
+        {
+            for (int dir = 0; dir < 4; ++dir)
+                link[dir] = map(other.link[dir]);
+            row = other.row;
+            col = other.col;
+        }
+
         template<int dir> experimental::generator<SetCell*> Traverse()
         {
             for (auto ptr = link[dir]; ptr != this; ptr = ptr->link[dir])
@@ -117,9 +141,78 @@ namespace DancingLinks
 
         // All preselected rows are recorded in this vector so they are prepended to every solution.
         std::vector<int> mSolutionPrefix;
+        // Flags for checking preselections without walking lists: rows in the prefix, columns covered by them
+        // and optional columns
+        std::vector<char> mRowSelected;
+        std::vector<char> mColumnTaken;
+        std::vector<char> mColumnOptional;
+        // At-least-once columns are optional ones too as far as the exact cover searches go; preselection leaves
+        // them alone and SolveMinimum keeps count of how many chosen rows cover each
+        std::vector<char> mColumnAtLeastOnce;
+        std::vector<int> mCoverage;
+        bool AtLeastOnce(int c) const { return c < (int)mColumnAtLeastOnce.size() && mColumnAtLeastOnce[c]; }
+        bool Primary(int c) const { return c >= (int)mColumnOptional.size() || !mColumnOptional[c]; }
+        // Columns taking up to a capacity of rows (more than one, otherwise they are plain optional ones) and how many
+        // selected or chosen rows use them. A row using one leaves it, the column is hidden once it is full.
+        std::vector<int> mColumnCapacity;
+        std::vector<int> mColumnLoad;
+        bool Counted(int c) const { return c < (int)mColumnCapacity.size() && mColumnCapacity[c] > 1; }
+        bool Full(int c) const { return Counted(c) && mColumnLoad[c] == mColumnCapacity[c]; }
+        // Excluded rows are taken out of their columns. The stack has ~r for rows that were out already (they
+        // overlap the selection or were excluded before) and only need the matching RestoreRow. Every entry notes
+        // how many rows were selected then: exclusions and preselections are undone together in reverse order, a
+        // row restored under a later selection would go back into hidden columns.
+        struct Exclusion
+        {
+            int row;
+            size_t selected;
+        };
+        std::vector<char> mRowExcluded;
+        std::vector<Exclusion> mExcludedRows;
+        // Rows tried first by SolveNear and their cells by column
+        std::vector<char> mRowPreferred;
+        std::vector<SetCell*> mColumnPreferred;
+        // Set by PreferredImp when the budget kept it from trying a row, a round without it searched everything
+        bool mBudgetCut = false;
+        // Fewest primary columns any row covers, see PrepareDepthBound
+        int mMinCover = 1;
+        // Rows of a column scored by PreferredImp, one buffer per depth below the preselected rows
+        std::vector<std::vector<std::pair<int, SetCell*>>> mCandidates;
+
+        // All cells (including headers and the root) are allocated from this arena and released together
+        // with the matrix. Blocks are never reallocated so cell addresses are stable.
+        static constexpr size_t cellBlockSize = 4096;
+        struct CellBlock
+        {
+            std::unique_ptr<SetCell[]> cells;
+            size_t size;
+        };
+        std::vector<CellBlock> mCellBlocks;
+        SetCell* mNextCell = nullptr;
+        size_t mCellsFree = 0;
+        size_t mCellCapacity = 0;
+        SetCell* AllocateCells(size_t count);
+
+        // Cells taken out of their columns by the search in UndoMode::trail, each with its column header. A hidden
+        // column logs its own header first so undoing knows where to stop.
+        UndoMode mUndoMode = UndoMode::relink;
+        struct TrailEntry
+        {
+            SetCell* cell;
+            SetCell* header;
+        };
+        std::vector<TrailEntry> mTrail;
+        bool Trailing() const { return mUndoMode == UndoMode::trail && state == solving; }
+
+        // Set by Stop, checked once per search node
+        std::atomic<bool> mStopRequested{ false };
+
+        // Live counters, see SolverMetrics.
+        SolverMetrics mMetrics;
+        void UpdateMemoryMetric();
 
         // Algorithm state for call flow validation.
-        enum State { init, setup, options, solving, done };
+        enum State { init, setup, options, solving };
         State state;
         void ValidateState(State s);
 
@@ -130,13 +223,47 @@ namespace DancingLinks
         SetCell*& GetRow(int r);
 
         void HideColumn(SetCell* ptr);
+        bool HideColumnChecked(SetCell* ptr);
         void UnhideColumn(SetCell* ptr);
+        // Take the column of a cell of a chosen row (and back): hide it, or count the row for a counted column
+        bool HideColumnOf(SetCell* cell, bool checked = false);
+        void UnhideColumnOf(SetCell* cell);
+        SetCell* PivotCell(SetCell* rowHeader);
+
+        // The search is templated on the callbacks so that internal users (counting, blocks) get them inlined
+        template<typename Try, typename Undo, typename Complete> void SolveImp(Try& tryRow, Undo& undoRow, Complete& complete);
+        void CountImp(uint64_t limit, uint64_t& count, std::vector<int>& solution, std::vector<int>* firstSolution);
+        void SplitImp(int depth, std::vector<int>& path, SolutionBlock& tasks);
+        void ApplyPath(std::span<const int> path);
+        void RetractPath(std::span<const int> path);
+        bool PreferredImp(int budget, int active, std::vector<int>& solution, std::vector<int>& result);
+        int PrepareDepthBound();
+        bool PreferredAvailable(int c);
+
+        // Branch and bound state of SolveMinimum
+        struct MinimumSearch
+        {
+            const std::vector<double>* costs;
+            bool unit;      // no costs given, every row costs 1
+            double price;   // lowest cost of covering one column
+            double bestCost;
+            std::vector<int> best;
 
-        void SolveImp(std::function<void(int)> tryRow, std::function<void(int)> undoRow, std::function<void()> complete);
+            double Cost(int r) const { return unit ? 1.0 : (*costs)[r]; }
+        };
+        void MinimumImp(double cost, std::vector<int>& path, MinimumSearch& search);
+        void CoverMixed(std::vector<int>& path, SetCell* cell);
+        void UncoverMixed(std::vector<int>& path, SetCell* cell);
+        void Satisfy(int c);
+        void Unsatisfy(int c);
+        void DetachCells(SetCell* cell);
+        void RestoreCells(SetCell* cell);
+        bool DiscrepancyImp(int maxDiscrepancies, std::vector<int>& path, std::vector<int>& result);
+        bool BeamImp(const SearchOptions& search, std::vector<int>& path, std::vector<int>& result);
 
         SetCell* MostConstrainedColumn();
-        void Cover(std::function<void(int)> tryRow, SetCell* cell);
-        void Uncover(std::function<void(int)> undoRow, SetCell* cell);
+        template<typename Try> void Cover(Try& tryRow, SetCell* cell);
+        template<typename Undo> void Uncover(Undo& undoRow, SetCell* cell);
 
     public:
         SparseMatrixImp();
@@ -146,11 +273,33 @@ namespace DancingLinks
 
         // SparseMatrix implementation
         virtual void SetCondition(int c, int r) override;
+        virtual void BuildRows(int rowCount, std::function<void(int, std::vector<int>&)> generator, int threads) override;
         virtual void SetConditionOptional(int c) override;
+        virtual void SetConditionAtLeastOnce(int c) override;
+        virtual void SetConditionCapacity(int c, int capacity) override;
         virtual void PreselectRow(int r) override;
+        virtual SelectStatus PreselectRows(std::span<const int> rows) override;
+        virtual void UnselectRow(int r) override;
+        virtual std::span<const int> SelectedRows() const override;
+        virtual SelectStatus ExcludeRow(int r) override;
+        virtual void RestoreRow(int r) override;
+        virtual int RowCount() const override;
+        virtual void RowColumns(int r, std::vector<int>& columns) const override;
+        virtual ColumnKind ColumnKindOf(int c) const override;
+        virtual SparseMatrix* Clone() const override;
+        virtual void SetUndoMode(UndoMode mode) override;
 
         virtual void Solve(std::function<void(int)> tryRow, std::function<void(int)> undoRow, std::function<void()> complete) override;
         virtual std::experimental::generator<const std::vector<int>> Solve() override;
+        virtual void SolveBlocks(std::function<void(const SolutionBlock&)> consumer, size_t blockSize) override;
+        virtual void SolveParallel(std::function<void(const SolutionBlock&)> consumer, int threads, size_t blockSize) override;
+        virtual uint64_t Count(uint64_t limit, std::vector<int>* firstSolution) override;
+        virtual bool SolveFirst(std::vector<int>& solution, const SearchOptions& search) override;
+        virtual bool SolveNear(const std::vector<int>& previous, std::vector<int>& solution, int maxDiscrepancies) override;
+        virtual bool SolveMinimum(std::vector<int>& solution, const std::vector<double>& costs) override;
+        virtual void Stop() override;
+
+        virtual const SolverMetrics& Metrics() const override;
     };
 
     // Class factory calls
@@ -182,7 +331,7 @@ namespace DancingLinks
     // Create a brand new column and return the header element as the insertion point
         if (ptr == nullptr)
         {
-            ptr = mColumns[c] = new SetCell;
+            ptr = mColumns[c] = AllocateCells(1);
             ptr->counter = 0;
             ptr->InsertBefore(mRoot);
             return ptr;
@@ -209,36 +358,36 @@ namespace DancingLinks
     }
 
 
+    SetCell* SparseMatrixImp::AllocateCells(size_t count)
+    {
+        if (count > mCellsFree)
+        {
+            size_t size = max(count, cellBlockSize);
+            mCellBlocks.push_back({ unique_ptr<SetCell[]>(new SetCell[size]), size });
+            mNextCell = mCellBlocks.back().cells.get();
+            mCellsFree = size;
+            mCellCapacity += size;
+        }
+
+        SetCell* cells = mNextCell;
+        mNextCell += count;
+        mCellsFree -= count;
+        return cells;
+    }
+
     SparseMatrixImp::SparseMatrixImp()
     {
-        mRoot = new SetCell;
+        mRoot = AllocateCells(1);
         mRoot->counter = numeric_limits<int>::max();
         state = init;
     }
 
     SparseMatrixImp::~SparseMatrixImp()
     {
-        // The row links stay intact all the time making it very easy to do a complete sweep
-        for(auto rowStart : mRows)
-            if (rowStart)
-            {
-                auto condemned = rowStart;
-                for (auto x : rowStart->Traverse<SetCell::right>())
-                {
-                    delete condemned;
-                    condemned = x;
-                }
-                delete condemned;
-            }
+        // All cells live in the arena, nothing to walk
         mRows.clear();
-
-        // Column headers
-        for (auto col : mColumns)
-            if (col)
-                delete col;
         mColumns.clear();
-
-        delete mRoot;
+        mCellBlocks.clear();
         mRoot = nullptr;
     }
 
@@ -250,7 +399,7 @@ namespace DancingLinks
         SetCell* ptrByCol = GetByColumn(c, r);
         if (ptrByCol->row != r) // duplicates are silently ignored
         {
-            SetCell* newCell = new SetCell;
+            SetCell* newCell = AllocateCells(1);
             newCell->col = c;
             newCell->row = r;
 
@@ -264,6 +413,170 @@ namespace DancingLinks
 
             mColumns[c]->counter++;
         }
+        UpdateMemoryMetric();
+    }
+
+    // Run f(0) .. f(threads - 1) concurrently, f(0) on the calling thread
+    template<typename F> static void RunParallel(int threads, F&& f)
+    {
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t)
+            pool.emplace_back([&f, t]() { f(t); });
+        f(0);
+        for (auto& th : pool)
+            th.join();
+    }
+
+    // Bulk construction. The result is identical to calling SetCondition for every row in order except that
+    // all cells are placed in one array sorted by column (then row) and column headers are created in column
+    // order. Steps:
+    //  1. every thread generates a contiguous range of rows into its own compressed row buffer;
+    //  2. per thread column histograms are combined into a counting sort so that every thread knows where its
+    //     cells go in the final array (the threads take rows in order so the columns come out sorted by row);
+    //  3. every thread scatters its cells into the final array;
+    //  4. up-down links are set per column range and left-right links per row range, again in parallel.
+    void SparseMatrixImp::BuildRows(int rowCount, function<void(int, vector<int>&)> generator, int threads)
+    {
+        ValidateState(setup);
+        assert(rowCount >= 0);
+        assert(mRows.empty() && mColumns.empty()); // bulk build only works on an empty matrix
+
+        if (threads <= 0)
+            threads = max(1, (int)thread::hardware_concurrency());
+        threads = max(1, min(threads, rowCount));
+
+        struct Chunk
+        {
+            int firstRow, endRow;
+            vector<size_t> offsets;     // compressed rows: columns of row firstRow + i are [offsets[i], offsets[i + 1])
+            vector<int> columns;
+            vector<SetCell*> cells;     // where each entry of columns went in the final array
+            vector<size_t> cursor;      // per column histogram, later turned into the write position
+            int maxColumn = -1;
+        };
+        vector<Chunk> chunks(threads);
+
+        RunParallel(threads, [&](int t) {
+            auto& chunk = chunks[t];
+            chunk.firstRow = int((long long)rowCount * t / threads);
+            chunk.endRow = int((long long)rowCount * (t + 1) / threads);
+            chunk.offsets.reserve(chunk.endRow - chunk.firstRow + 1);
+            chunk.offsets.push_back(0);
+
+            vector<int> row;
+            for (int r = chunk.firstRow; r < chunk.endRow; ++r)
+            {
+                row.clear();
+                generator(r, row);
+                sort(row.begin(), row.end());
+                row.erase(unique(row.begin(), row.end()), row.end()); // duplicates are silently ignored
+                assert(row.empty() || row.front() >= 0);
+                if (!row.empty())
+                    chunk.maxColumn = max(chunk.maxColumn, row.back());
+                chunk.columns.insert(chunk.columns.end(), row.begin(), row.end());
+                chunk.offsets.push_back(chunk.columns.size());
+            }
+        });
+
+        int columnCount = 0;
+        for (auto& chunk : chunks)
+            columnCount = max(columnCount, chunk.maxColumn + 1);
+
+        RunParallel(threads, [&](int t) {
+            auto& chunk = chunks[t];
+            chunk.cursor.assign(columnCount, 0);
+            for (int c : chunk.columns)
+                ++chunk.cursor[c];
+        });
+
+        // Column start offsets. The totals are cheap compared to the rest, just do them in one sweep.
+        vector<size_t> columnStart(columnCount + 1, 0);
+        for (int c = 0; c < columnCount; ++c)
+        {
+            size_t position = columnStart[c];
+            for (auto& chunk : chunks)
+            {
+                size_t count = chunk.cursor[c];
+                chunk.cursor[c] = position;
+                position += count;
+            }
+            columnStart[c + 1] = position;
+        }
+
+        size_t cellCount = columnStart[columnCount];
+        SetCell* cells = cellCount ? AllocateCells(cellCount) : nullptr;
+
+        RunParallel(threads, [&](int t) {
+            auto& chunk = chunks[t];
+            chunk.cells.resize(chunk.columns.size());
+            for (int r = chunk.firstRow; r < chunk.endRow; ++r)
+                for (size_t i = chunk.offsets[r - chunk.firstRow]; i < chunk.offsets[r - chunk.firstRow + 1]; ++i)
+                {
+                    SetCell* cell = chunk.cells[i] = cells + chunk.cursor[chunk.columns[i]]++;
+                    cell->row = r;
+                    cell->col = chunk.columns[i];
+                }
+        });
+
+        // Headers are only created for columns that have cells, same as SetCondition does
+        mColumns.resize(columnCount, nullptr);
+        mRows.resize(rowCount, nullptr);
+        for (int c = 0; c < columnCount; ++c)
+            if (columnStart[c + 1] > columnStart[c])
+            {
+                mColumns[c] = AllocateCells(1);
+                mColumns[c]->InsertBefore(mRoot);
+            }
+
+        RunParallel(threads, [&](int t) {
+            for (int c = int((long long)columnCount * t / threads); c < int((long long)columnCount * (t + 1) / threads); ++c)
+            {
+                SetCell* header = mColumns[c];
+                if (header == nullptr)
+                    continue;
+                header->counter = int(columnStart[c + 1] - columnStart[c]);
+                SetCell* prev = header;
+                for (size_t i = columnStart[c]; i < columnStart[c + 1]; ++i)
+                {
+                    cells[i].Link<SetCell::up>(prev);
+                    prev->Link<SetCell::down>(cells + i);
+                    prev = cells + i;
+                }
+                prev->Link<SetCell::down>(header);
+                header->Link<SetCell::up>(prev);
+            }
+
+            auto& chunk = chunks[t];
+            for (int r = chunk.firstRow; r < chunk.endRow; ++r)
+            {
+                size_t first = chunk.offsets[r - chunk.firstRow], last = chunk.offsets[r - chunk.firstRow + 1];
+                if (first == last)
+                    continue;
+                SetCell* prev = chunk.cells[last - 1];
+                for (size_t i = first; i < last; ++i)
+                {
+                    chunk.cells[i]->Link<SetCell::left>(prev);
+                    prev->Link<SetCell::right>(chunk.cells[i]);
+                    prev = chunk.cells[i];
+                }
+                mRows[r] = chunk.cells[first];
+            }
+        });
+
+        UpdateMemoryMetric();
+    }
+
+    void SparseMatrixImp::UpdateMemoryMetric()
+    {
+        size_t bytes = sizeof(SparseMatrixImp) + mCellCapacity * sizeof(SetCell) +
+            (mColumns.capacity() + mRows.capacity()) * sizeof(SetCell*) + mSolutionPrefix.capacity() * sizeof(int) +
+            mTrail.capacity() * sizeof(TrailEntry);
+        mMetrics.memoryBytes.store(bytes, memory_order_relaxed);
+    }
+
+    const SolverMetrics& SparseMatrixImp::Metrics() const
+    {
+        return mMetrics;
     }
 
     void SparseMatrixImp::SetConditionOptional(int c)
@@ -277,31 +590,324 @@ namespace DancingLinks
             ptr->RowDetach();
             ptr->Orphan();
         }
+
+        mColumnOptional.resize(mColumns.size(), 0);
+        mColumnOptional[c] = 1;
+    }
+
+    void SparseMatrixImp::SetConditionAtLeastOnce(int c)
+    {
+        SetConditionOptional(c);
+        mColumnAtLeastOnce.resize(mColumns.size(), 0);
+        mColumnAtLeastOnce[c] = 1;
+    }
+
+    void SparseMatrixImp::SetConditionCapacity(int c, int capacity)
+    {
+        assert(capacity >= 1 && !AtLeastOnce(c));
+        SetConditionOptional(c);
+        mColumnCapacity.resize(mColumns.size(), 1);
+        mColumnLoad.resize(mColumns.size(), 0);
+        mColumnCapacity[c] = capacity;
     }
 
     void SparseMatrixImp::PreselectRow(int r)
+    {
+        SelectStatus status = PreselectRows({ &r, 1 });
+        assert(status != SelectStatus::conflict);
+    }
+
+    SelectStatus SparseMatrixImp::PreselectRows(span<const int> rows)
+    {
+        ValidateState(options);
+        mRowSelected.resize(mRows.size(), 0);
+        mColumnTaken.resize(mColumns.size(), 0);
+        mColumnOptional.resize(mColumns.size(), 0);
+
+        // Check first: every column may be taken once, a counted one up to its capacity. The rows are marked as
+        // they go so duplicates are skipped; on a conflict all marks of this call are cleared again. At-least-once
+        // columns can be shared and are not hidden, they are not looked at here.
+        size_t first = mSolutionPrefix.size();
+        auto cellsOf = [this](int r, auto f)
+            {
+                if (SetCell* rowHeader = mRows[r])
+                {
+                    if (!AtLeastOnce(rowHeader->col))
+                        f(rowHeader);
+                    for (auto c : rowHeader->Traverse<SetCell::right>())
+                        if (!AtLeastOnce(c->col))
+                            f(c);
+                }
+            };
+        // Counted columns are counted here only for the check, hiding counts them again
+        auto mark = [this](SetCell* cell, int delta)
+            {
+                if (Counted(cell->col))
+                    mColumnLoad[cell->col] += delta;
+                else
+                    mColumnTaken[cell->col] = delta > 0;
+            };
+
+        bool conflict = false;
+        for (int r : rows)
+        {
+            assert(r >= 0 && r < (int)mRows.size());
+            if (mRowSelected[r])
+                continue;
+            conflict = r < (int)mRowExcluded.size() && mRowExcluded[r];
+            cellsOf(r, [this, &conflict](SetCell* cell) { conflict = conflict || mColumnTaken[cell->col] || Full(cell->col); });
+            if (conflict)
+                break;
+            cellsOf(r, [&mark](SetCell* cell) { mark(cell, 1); });
+            mRowSelected[r] = 1;
+            mSolutionPrefix.push_back(r);
+        }
+
+        for (size_t i = first; i < mSolutionPrefix.size(); ++i)
+            cellsOf(mSolutionPrefix[i], [this, conflict, &mark](SetCell* cell)
+                {
+                    if (conflict || Counted(cell->col))
+                        mark(cell, -1);
+                });
+        if (conflict)
+        {
+            for (size_t i = first; i < mSolutionPrefix.size(); ++i)
+                mRowSelected[mSolutionPrefix[i]] = 0;
+            mSolutionPrefix.resize(first);
+            return SelectStatus::conflict;
+        }
+
+        // Now hide, noting required columns left without rows on the way. A row with nothing but counted and
+        // at-least-once columns is taken out of all its columns by hand, as no hiding does it.
+        bool infeasible = false;
+        for (size_t i = first; i < mSolutionPrefix.size(); ++i)
+        {
+            SetCell* rowHeader = mRows[mSolutionPrefix[i]];
+            if (rowHeader == nullptr)
+                continue;
+            SetCell* pivot = PivotCell(rowHeader);
+            if (pivot == nullptr)
+            {
+                DetachCells(rowHeader);
+                pivot = rowHeader;
+            }
+
+            if (!AtLeastOnce(pivot->col))
+                infeasible = HideColumnOf(pivot, true) || infeasible;
+            for (auto c : pivot->Traverse<SetCell::right>())
+                if (!AtLeastOnce(c->col))
+                    infeasible = HideColumnOf(c, true) || infeasible;
+        }
+
+        return infeasible ? SelectStatus::infeasible : SelectStatus::ok;
+    }
+
+    void SparseMatrixImp::UnselectRow(int r)
+    {
+        ValidateState(options);
+        assert(!mSolutionPrefix.empty() && mSolutionPrefix.back() == r); // only the last preselected row
+        assert(mExcludedRows.empty() || mExcludedRows.back().selected < mSolutionPrefix.size()); // restore later exclusions first
+
+        // Exactly the reverse of PreselectRow
+        SetCell* rowHeader = mRows[r];
+        if (rowHeader)
+        {
+            SetCell* pivot = PivotCell(rowHeader);
+            SetCell* start = pivot ? pivot : rowHeader;
+            for (auto c : start->Traverse<SetCell::left>())
+            {
+                if (!AtLeastOnce(c->col))
+                    UnhideColumnOf(c);
+            }
+            if (!AtLeastOnce(start->col))
+                UnhideColumnOf(start);
+            if (pivot == nullptr)
+                RestoreCells(rowHeader);
+
+            mColumnTaken[rowHeader->col] = 0;
+            for (auto c : rowHeader->Traverse<SetCell::right>())
+                mColumnTaken[c->col] = 0;
+        }
+        mRowSelected[r] = 0;
+        mSolutionPrefix.pop_back();
+    }
+
+    span<const int> SparseMatrixImp::SelectedRows() const
+    {
+        return mSolutionPrefix;
+    }
+
+    SelectStatus SparseMatrixImp::ExcludeRow(int r)
     {
         ValidateState(options);
         assert(r >= 0 && r < (int)mRows.size());
+        mRowSelected.resize(mRows.size(), 0);
+        mColumnTaken.resize(mColumns.size(), 0);
+        mColumnOptional.resize(mColumns.size(), 0);
+        mRowExcluded.resize(mRows.size(), 0);
+
+        if (mRowSelected[r])
+            return SelectStatus::conflict;
+
+        // A row overlapping the selection is not in its columns any more (hiding took it out), detaching it
+        // again would break the links
+        SetCell* rowHeader = mRows[r];
+        bool out = mRowExcluded[r] || rowHeader == nullptr || mColumnTaken[rowHeader->col] || Full(rowHeader->col);
+        if (!out)
+            for (auto c : rowHeader->Traverse<SetCell::right>())
+                out = out || mColumnTaken[c->col] || Full(c->col);
+        if (out)
+        {
+            mExcludedRows.push_back({ ~r, mSolutionPrefix.size() });
+            return SelectStatus::ok;
+        }
+
+        bool infeasible = false;
+        rowHeader->ColumnDetach();
+        infeasible = --mColumns[rowHeader->col]->counter == 0 && !mColumnOptional[rowHeader->col];
+        for (auto c : rowHeader->Traverse<SetCell::right>())
+        {
+            c->ColumnDetach();
+            if (--mColumns[c->col]->counter == 0 && !mColumnOptional[c->col])
+                infeasible = true;
+        }
+        mRowExcluded[r] = 1;
+        mExcludedRows.push_back({ r, mSolutionPrefix.size() });
+        return infeasible ? SelectStatus::infeasible : SelectStatus::ok;
+    }
+
+    void SparseMatrixImp::RestoreRow(int r)
+    {
+        ValidateState(options);
+        assert(!mExcludedRows.empty() && (mExcludedRows.back().row == r || mExcludedRows.back().row == ~r)); // only the last excluded row
+        assert(mExcludedRows.back().selected == mSolutionPrefix.size()); // unselect later rows first
 
-        if (std::find(mSolutionPrefix.begin(), mSolutionPrefix.end(), r) == mSolutionPrefix.end())
+        if (mExcludedRows.back().row == r)
         {
             SetCell* rowHeader = mRows[r];
-            if (rowHeader)
+            for (auto c : rowHeader->Traverse<SetCell::left>())
             {
-                HideColumn(mColumns[rowHeader->col]);
-                for (auto c : rowHeader->Traverse<SetCell::right>())
-                {
-                    HideColumn(mColumns[c->col]);
-                }
+                c->ColumnRestore();
+                ++mColumns[c->col]->counter;
             }
-            mSolutionPrefix.push_back(r);
+            rowHeader->ColumnRestore();
+            ++mColumns[rowHeader->col]->counter;
+            mRowExcluded[r] = 0;
+        }
+        mExcludedRows.pop_back();
+    }
+
+    int SparseMatrixImp::RowCount() const
+    {
+        return (int)mRows.size();
+    }
+
+    void SparseMatrixImp::RowColumns(int r, vector<int>& columns) const
+    {
+        assert(state != solving);
+        assert(r >= 0 && r < (int)mRows.size());
+
+        columns.clear();
+        SetCell* cell = mRows[r];
+        if (cell != nullptr)
+        {
+            columns.push_back(cell->col);
+            for (auto test : cell->Traverse<SetCell::right>())
+                columns.push_back(test->col);
+        }
+    }
+
+    ColumnKind SparseMatrixImp::ColumnKindOf(int c) const
+    {
+        assert(c >= 0);
+        if (AtLeastOnce(c))
+            return ColumnKind::atLeastOnce;
+        if (Counted(c))
+            return ColumnKind::capacity;
+        if (c < (int)mColumnOptional.size() && mColumnOptional[c])
+            return ColumnKind::optional;
+        return ColumnKind::exact;
+    }
+
+    // Deep copy: all cells go into one block and every link is translated through the offset of the block it
+    // points into, so hidden columns, preselected and excluded rows all carry over as they are
+    SparseMatrix* SparseMatrixImp::Clone() const
+    {
+        assert(state != solving);
+
+        vector<pair<const SetCell*, size_t>> blocks;
+        size_t total = 0;
+        for (auto& block : mCellBlocks)
+        {
+            blocks.emplace_back(block.cells.get(), total);
+            total += block.size;
+        }
+        sort(blocks.begin(), blocks.end(), [](const auto& a, const auto& b) { return less<const SetCell*>()(a.first, b.first); });
+
+        SparseMatrixImp* copy = new SparseMatrixImp;
+        copy->mCellBlocks.clear();
+        copy->mCellsFree = copy->mCellCapacity = 0;
+        SetCell* cells = copy->AllocateCells(total);
+
+        auto map = [&blocks, cells](const SetCell* ptr) -> SetCell*
+            {
+                if (ptr == nullptr)
+                    return nullptr;
+                auto it = upper_bound(blocks.begin(), blocks.end(), ptr,
+                    [](const SetCell* p, const auto& block) { return less<const SetCell*>()(p, block.first); });
+                --it;
+                return cells + it->second + (ptr - it->first);
+            };
+        for (auto& block : mCellBlocks)
+        {
+            SetCell* target = map(block.cells.get());
+            for (size_t i = 0; i < block.size; ++i)
+                target[i].CopyFrom(block.cells[i], map);
         }
+
+        copy->mRoot = map(mRoot);
+        copy->mColumns.resize(mColumns.size());
+        transform(mColumns.begin(), mColumns.end(), copy->mColumns.begin(), map);
+        copy->mRows.resize(mRows.size());
+        transform(mRows.begin(), mRows.end(), copy->mRows.begin(), map);
+        copy->mSolutionPrefix = mSolutionPrefix;
+        copy->mRowSelected = mRowSelected;
+        copy->mColumnTaken = mColumnTaken;
+        copy->mColumnOptional = mColumnOptional;
+        copy->mColumnAtLeastOnce = mColumnAtLeastOnce;
+        copy->mColumnCapacity = mColumnCapacity;
+        copy->mColumnLoad = mColumnLoad;
+        copy->mRowExcluded = mRowExcluded;
+        copy->mExcludedRows = mExcludedRows;
+        copy->mUndoMode = mUndoMode;
+        copy->state = state;
+        copy->UpdateMemoryMetric();
+        return copy;
+    }
+
+    void SparseMatrixImp::SetUndoMode(UndoMode mode)
+    {
+        assert(state != solving);
+        mUndoMode = mode;
     }
 
     void SparseMatrixImp::HideColumn(SetCell* ptr)
     {
-        if (ptr != nullptr)
+        if (ptr != nullptr && Trailing())
+        {
+            ptr->RowDetach();
+            mTrail.push_back({ ptr, ptr });
+
+            for (auto i : ptr->Traverse<SetCell::down>())
+                for (auto j : i->Traverse<SetCell::right>())
+                {
+                    SetCell* header = mColumns[j->col];
+                    j->ColumnDetach();
+                    --header->counter;
+                    mTrail.push_back({ j, header });
+                }
+        }
+        else if (ptr != nullptr)
         {
             ptr->RowDetach();
 
@@ -314,9 +920,44 @@ namespace DancingLinks
         }
     }
 
-    void SparseMatrixImp::UnhideColumn(SetCell* ptr)
+    // HideColumn for preselection: also reports whether a required column not taken by the preselected rows has
+    // no rows left
+    bool SparseMatrixImp::HideColumnChecked(SetCell* ptr)
     {
+        bool emptied = false;
         if (ptr != nullptr)
+        {
+            ptr->RowDetach();
+
+            for (auto i : ptr->Traverse<SetCell::down>())
+                for (auto j : i->Traverse<SetCell::right>())
+                {
+                    j->ColumnDetach();
+                    if (--mColumns[j->col]->counter == 0 && !mColumnTaken[j->col] && !mColumnOptional[j->col])
+                        emptied = true;
+                }
+        }
+        return emptied;
+    }
+
+    void SparseMatrixImp::UnhideColumn(SetCell* ptr)
+    {
+        if (ptr != nullptr && Trailing())
+        {
+            // Columns are unhidden in reverse order of hiding, so this column's cells are at the end of the trail
+            for (;;)
+            {
+                TrailEntry entry = mTrail.back();
+                mTrail.pop_back();
+                if (entry.cell == ptr)
+                    break;
+                entry.cell->ColumnRestore();
+                ++entry.header->counter;
+            }
+
+            ptr->RowRestore();
+        }
+        else if (ptr != nullptr)
         {
             for (auto i : ptr->Traverse<SetCell::up>())
                 for (auto j : i->Traverse<SetCell::left>())
@@ -329,6 +970,39 @@ namespace DancingLinks
         }
     }
 
+    // The row of the cell is out of its columns already (hiding the column it was chosen from took it out), so a
+    // counted column only counts it until it is full. With checked set reports a required column left without
+    // rows like HideColumnChecked.
+    bool SparseMatrixImp::HideColumnOf(SetCell* cell, bool checked)
+    {
+        int c = cell->col;
+        if (Counted(c) && ++mColumnLoad[c] < mColumnCapacity[c])
+            return false;
+        if (checked)
+            return HideColumnChecked(mColumns[c]);
+        HideColumn(mColumns[c]);
+        return false;
+    }
+
+    void SparseMatrixImp::UnhideColumnOf(SetCell* cell)
+    {
+        int c = cell->col;
+        if (!Counted(c) || mColumnLoad[c]-- == mColumnCapacity[c])
+            UnhideColumn(mColumns[c]);
+    }
+
+    // The cell to start hiding the columns of a row from, one whose hiding takes the row out of the others: any
+    // but a counted or at-least-once column. Null if the row has no such column.
+    SetCell* SparseMatrixImp::PivotCell(SetCell* rowHeader)
+    {
+        if (!Counted(rowHeader->col) && !AtLeastOnce(rowHeader->col))
+            return rowHeader;
+        for (auto c : rowHeader->Traverse<SetCell::right>())
+            if (!Counted(c->col) && !AtLeastOnce(c->col))
+                return c;
+        return nullptr;
+    }
+
     SetCell* SparseMatrixImp::MostConstrainedColumn()
     {
         auto col = mRoot;
@@ -346,29 +1020,34 @@ namespace DancingLinks
         return col;
     }
 
-    void SparseMatrixImp::Cover(std::function<void(int)> tryRow, SetCell* cell)
+    template<typename Try> void SparseMatrixImp::Cover(Try& tryRow, SetCell* cell)
     {
         tryRow(cell->row);
+        SolverMetrics::Add(mMetrics.nodes, uint64_t(1));
+        SolverMetrics::Add(mMetrics.depth, 1);
 
         for (auto test : cell->Traverse<SetCell::right>())
-            HideColumn(mColumns[test->col]);
+            HideColumnOf(test);
     }
 
-    void SparseMatrixImp::Uncover(std::function<void(int)> undoRow, SetCell* cell)
+    template<typename Undo> void SparseMatrixImp::Uncover(Undo& undoRow, SetCell* cell)
     {
         for (auto test : cell->Traverse<SetCell::left>())
-            UnhideColumn(mColumns[test->col]);
+            UnhideColumnOf(test);
 
+        SolverMetrics::Add(mMetrics.depth, -1);
         undoRow(cell->row);
     }
 
 // The recursive implementation is very simple and straightforward.
-    void SparseMatrixImp::SolveImp(function<void(int)> tryRow, function<void(int)> undoRow, function<void()> complete)
+    template<typename Try, typename Undo, typename Complete>
+    void SparseMatrixImp::SolveImp(Try& tryRow, Undo& undoRow, Complete& complete)
     {
         // Find the most constrained column if any
         auto col = MostConstrainedColumn();
         if (col == mRoot)
         {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
             complete();
             return;
         }
@@ -387,56 +1066,957 @@ namespace DancingLinks
             SolveImp(tryRow, undoRow, complete);
 
             Uncover(undoRow, cell);
+
+            if (mStopRequested.load(memory_order_relaxed))
+                break;
         }
 
         UnhideColumn(col);
     }
 
+    void SparseMatrixImp::Stop()
+    {
+        mStopRequested.store(true, memory_order_relaxed);
+    }
+
     void SparseMatrixImp::Solve(std::function<void(int)> tryRow, std::function<void(int)> undoRow, std::function<void()> complete)
     {
         ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
         for (int p : mSolutionPrefix)
             tryRow(p);
         SolveImp(tryRow, undoRow, complete);
-        state = done;
+        state = options;
     }
 
-    // The generator uses an iterative implementation of the algorith. The issue with the recursive implmentation is that it would
-    // yield a solution from some deeper recursion level meaning that the recursive function itself should be a generator. Calling a
-    // generator is not free and that implementation would incur a significant performance cost.
-    experimental::generator<const vector<int>> SparseMatrixImp::Solve()
+    // The recursive solver does the work, completed solutions are appended to the block
+    void SparseMatrixImp::SolveBlocks(function<void(const SolutionBlock&)> consumer, size_t blockSize)
     {
         ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+        assert(blockSize > 0);
 
-        vector<int> solution;
+        SolutionBlock block;
+        block.offsets.reserve(blockSize + 1);
+        block.offsets.push_back(0);
 
+        vector<int> solution = mSolutionPrefix;
         auto tryRow = [&solution](int r) { solution.push_back(r); };
-        auto undoRow = [&solution](int r) { solution.pop_back(); };
+        auto undoRow = [&solution](int) { solution.pop_back(); };
+        auto complete = [&]()
+            {
+                block.rows.insert(block.rows.end(), solution.begin(), solution.end());
+                block.offsets.push_back(block.rows.size());
+                if (block.Count() == blockSize)
+                {
+                    consumer(block);
+                    block.rows.clear();
+                    block.offsets.resize(1);
+                }
+            };
+        SolveImp(tryRow, undoRow, complete);
 
-        for (int p : mSolutionPrefix)
-            tryRow(p);
+        if (block.Count() > 0)
+            consumer(block);
+        state = options;
+    }
 
+    // Paths of the search tree depth levels down (or less where a solution is reached sooner), in the order the
+    // search visits them. Dead ends are left out.
+    void SparseMatrixImp::SplitImp(int depth, vector<int>& path, SolutionBlock& tasks)
+    {
         auto col = MostConstrainedColumn();
+        if (col == nullptr)
+            return;
+        if (col == mRoot || depth == 0)
+        {
+            tasks.rows.insert(tasks.rows.end(), path.begin(), path.end());
+            tasks.offsets.push_back(tasks.rows.size());
+            return;
+        }
 
-        if (col == mRoot)
+        HideColumn(col);
+        for (auto cell : col->Traverse<SetCell::down>())
         {
-            co_yield solution;
+            for (auto test : cell->Traverse<SetCell::right>())
+                HideColumnOf(test);
+            path.push_back(cell->row);
+
+            SplitImp(depth - 1, path, tasks);
+
+            path.pop_back();
+            for (auto test : cell->Traverse<SetCell::left>())
+                UnhideColumnOf(test);
         }
+        UnhideColumn(col);
+    }
 
-        if (col != mRoot && col != nullptr)
+    // Hide the columns of the rows like the search does when it gets there. The columns are hidden in another
+    // order but removing cells leaves the rest of every list in the same order, so the search below continues as
+    // it would have. The search chose every row from a primary column, there is always a pivot.
+    void SparseMatrixImp::ApplyPath(span<const int> path)
+    {
+        for (int r : path)
         {
-            // This is the backtracking step. The first element of the pair is the current column header,
-            // the second is the row being tested.
-            vector<pair<SetCell*, SetCell*>> stack;
+            SetCell* cell = PivotCell(mRows[r]);
+            assert(cell != nullptr);
+            HideColumnOf(cell);
+            for (auto test : cell->Traverse<SetCell::right>())
+                HideColumnOf(test);
+        }
+    }
 
-            stack.push_back(make_pair(col, col));
-            HideColumn(stack.back().first);
+    void SparseMatrixImp::RetractPath(span<const int> path)
+    {
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+        {
+            SetCell* cell = PivotCell(mRows[*it]);
+            for (auto test : cell->Traverse<SetCell::left>())
+                UnhideColumnOf(test);
+            UnhideColumnOf(cell);
+        }
+    }
 
-            while (true)
+    void SparseMatrixImp::SolveParallel(function<void(const SolutionBlock&)> consumer, int threads, size_t blockSize)
+    {
+        assert(blockSize > 0);
+        if (threads <= 0)
+            threads = max(1, (int)thread::hardware_concurrency());
+
+        // The copies are made first, the matrix cannot be cloned while solving
+        vector<unique_ptr<SparseMatrixImp>> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back(static_cast<SparseMatrixImp*>(Clone()));
+
+        ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+
+        // Go deeper until there are enough subtrees to keep the threads busy when they turn out uneven
+        constexpr int tasksPerThread = 16;
+        constexpr int maxSplitDepth = 8;
+        SolutionBlock tasks;
+        vector<int> path;
+        for (int depth = 1; ; ++depth)
+        {
+            tasks.rows.clear();
+            tasks.offsets.assign(1, 0);
+            SplitImp(depth, path, tasks);
+            if (tasks.Count() >= size_t(tasksPerThread * threads) || depth == maxSplitDepth)
+                break;
+        }
+        size_t taskCount = tasks.Count();
+
+        // Blocks of every subtree in order. The head subtree is the one being passed on, its thread never waits.
+        struct TaskOutput
+        {
+            deque<SolutionBlock> blocks;
+            bool done = false;
+        };
+        vector<TaskOutput> outputs(taskCount);
+        mutex guard;
+        condition_variable changed;
+        size_t next = 0;
+        size_t head = 0;
+        size_t pending = 0;
+        size_t maxPending = 4 * size_t(threads);
+        bool abort = false;
+
+        auto work = [&](SparseMatrixImp* dlx)
             {
-                // Undo the last step unless we just started with this column
-                if (stack.back().second->row != numeric_limits<int>::max())
-                    Uncover(undoRow, stack.back().second);
+                dlx->ValidateState(solving);
+                size_t task = 0;
+                uint64_t nodes = 0, solutions = 0;
+                SolutionBlock block;
+                block.offsets.push_back(0);
+
+                auto deliver = [&](bool done)
+                    {
+                        unique_lock<mutex> lock(guard);
+                        changed.wait(lock, [&]() { return abort || task == head || pending < maxPending; });
+                        if (abort)
+                        {
+                            dlx->Stop();
+                        }
+                        else
+                        {
+                            if (block.Count() > 0)
+                            {
+                                outputs[task].blocks.push_back(move(block));
+                                ++pending;
+                            }
+                            outputs[task].done = done;
+                            changed.notify_all();
+                        }
+
+                        // Counters of the copies are added up here, under the lock there is a single writer
+                        uint64_t n = dlx->mMetrics.nodes.load(memory_order_relaxed);
+                        uint64_t s = dlx->mMetrics.solutions.load(memory_order_relaxed);
+                        SolverMetrics::Add(mMetrics.nodes, n - nodes);
+                        SolverMetrics::Add(mMetrics.solutions, s - solutions);
+                        nodes = n;
+                        solutions = s;
+
+                        block.rows.clear();
+                        block.offsets.assign(1, 0);
+                    };
+
+                vector<int> solution;
+                auto tryRow = [&solution](int r) { solution.push_back(r); };
+                auto undoRow = [&solution](int) { solution.pop_back(); };
+                auto complete = [&]()
+                    {
+                        block.rows.insert(block.rows.end(), solution.begin(), solution.end());
+                        block.offsets.push_back(block.rows.size());
+                        if (block.Count() == blockSize)
+                            deliver(false);
+                    };
+
+                for (;;)
+                {
+                    {
+                        lock_guard<mutex> lock(guard);
+                        if (abort || next == taskCount)
+                            break;
+                        task = next++;
+                    }
+
+                    span<const int> path(tasks.rows.data() + tasks.offsets[task], tasks.offsets[task + 1] - tasks.offsets[task]);
+                    solution = mSolutionPrefix;
+                    solution.insert(solution.end(), path.begin(), path.end());
+                    dlx->ApplyPath(path);
+                    dlx->SolveImp(tryRow, undoRow, complete);
+                    dlx->RetractPath(path);
+                    deliver(true);
+                }
+                dlx->state = options;
+            };
+
+        auto emit = [&]()
+            {
+                unique_lock<mutex> lock(guard);
+                while (head < taskCount)
+                {
+                    changed.wait(lock, [&]() { return !outputs[head].blocks.empty() || outputs[head].done; });
+                    if (outputs[head].blocks.empty())
+                    {
+                        ++head;
+                        changed.notify_all();
+                        continue;
+                    }
+
+                    SolutionBlock block = move(outputs[head].blocks.front());
+                    outputs[head].blocks.pop_front();
+                    --pending;
+                    changed.notify_all();
+
+                    lock.unlock();
+                    consumer(block);
+                    lock.lock();
+
+                    if (mStopRequested.load(memory_order_relaxed))
+                    {
+                        abort = true;
+                        for (auto& worker : workers)
+                            worker->Stop();
+                        changed.notify_all();
+                        break;
+                    }
+                }
+            };
+
+        RunParallel(threads + 1, [&](int t)
+            {
+                if (t == 0)
+                    emit();
+                else
+                    work(workers[t - 1].get());
+            });
+        state = options;
+    }
+
+    // Same as SolveImp but collects the rows itself and unwinds as soon as the limit is reached
+    void SparseMatrixImp::CountImp(uint64_t limit, uint64_t& count, vector<int>& solution, vector<int>* firstSolution)
+    {
+        auto col = MostConstrainedColumn();
+        if (col == mRoot)
+        {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+            if (count++ == 0 && firstSolution)
+                *firstSolution = solution;
+            return;
+        }
+        else if (col == nullptr)
+        {
+            return;
+        }
+
+        HideColumn(col);
+
+        auto tryRow = [&solution](int r) { solution.push_back(r); };
+        auto undoRow = [&solution](int) { solution.pop_back(); };
+        for (auto cell : col->Traverse<SetCell::down>())
+        {
+            Cover(tryRow, cell);
+            CountImp(limit, count, solution, firstSolution);
+            Uncover(undoRow, cell);
+
+            if (count >= limit || mStopRequested.load(memory_order_relaxed))
+                break;
+        }
+
+        UnhideColumn(col);
+    }
+
+    uint64_t SparseMatrixImp::Count(uint64_t limit, vector<int>* firstSolution)
+    {
+        ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+
+        vector<int> solution = mSolutionPrefix;
+        uint64_t count = 0;
+        if (limit > 0)
+            CountImp(limit, count, solution, firstSolution);
+
+        state = options;
+        return count;
+    }
+
+    // A preferred cell is still in its column unless its row was taken out by the rows chosen so far
+    bool SparseMatrixImp::PreferredAvailable(int c)
+    {
+        if (mColumnPreferred.empty())
+            return false;
+        SetCell* cell = mColumnPreferred[c];
+        return cell != nullptr && cell->Move<SetCell::up>()->Move<SetCell::down>() == cell;
+    }
+
+    // Find-first search taking the preferred rows of a column before the others, and the others in the order of how
+    // many preferred rows still available they would push out (the repair spreads as little as possible). Every row
+    // after the first one tried in a column is a discrepancy; budget is the number of them the path has to take
+    // (negative means any number). Active is the number of primary columns left: a path has at most active /
+    // mMinCover levels to go, and one that cannot spend its budget there is not followed.
+    bool SparseMatrixImp::PreferredImp(int budget, int active, vector<int>& solution, vector<int>& result)
+    {
+        if (budget > 0 && budget > active / mMinCover)
+            return false;
+
+        auto col = MostConstrainedColumn();
+        if (col == mRoot)
+        {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+            result = solution;
+            return true;
+        }
+        else if (col == nullptr)
+        {
+            return false;
+        }
+
+        HideColumn(col);
+
+        auto tryRow = [&solution](int r) { solution.push_back(r); };
+        auto undoRow = [&solution](int) { solution.pop_back(); };
+        // The first row tried in the column is free, every other one is a discrepancy. Returns whether to go on
+        // with the next row.
+        bool found = false;
+        auto attempt = [&](SetCell* cell, bool discrepancy)
+            {
+                if (discrepancy && budget == 0)
+                {
+                    mBudgetCut = true;
+                    return false;
+                }
+                int left = active - 1;
+                for (auto other : cell->Traverse<SetCell::right>())
+                    left -= Primary(other->col);
+
+                Cover(tryRow, cell);
+                found = PreferredImp(discrepancy && budget > 0 ? budget - 1 : budget, left, solution, result);
+                Uncover(undoRow, cell);
+                return !found && !mStopRequested.load(memory_order_relaxed);
+            };
+
+        if (mColumnPreferred.empty())
+        {
+            // Nothing preferred: the rows in their order, as the plain search takes them
+            bool discrepancy = false;
+            for (auto cell : col->Traverse<SetCell::down>())
+            {
+                if (!attempt(cell, discrepancy))
+                    break;
+                discrepancy = true;
+            }
+            UnhideColumn(col);
+            return found;
+        }
+
+        // The preferred row of the column is found without a walk. Only if it is gone or fails are the other rows
+        // scored and sorted, into the buffer of this depth.
+        int c = col->Move<SetCell::down>()->col;
+        SetCell* first = PreferredAvailable(c) ? mColumnPreferred[c] : nullptr;
+        bool more = first == nullptr || attempt(first, false);
+        if (more && first != nullptr && budget == 0)
+        {
+            // All the others would be discrepancies
+            mBudgetCut = mBudgetCut || col->counter > 1;
+            more = false;
+        }
+        if (more)
+        {
+            auto& candidates = mCandidates[solution.size() - mSolutionPrefix.size()];
+            candidates.clear();
+            for (auto cell : col->Traverse<SetCell::down>())
+            {
+                if (cell == first)
+                    continue;
+                int cost = mRowPreferred[cell->row] ? -1 : 0;
+                if (cost == 0)
+                {
+                    for (auto other : cell->Traverse<SetCell::right>())
+                        if (PreferredAvailable(other->col))
+                            ++cost;
+                }
+                candidates.emplace_back(cost, cell);
+            }
+            stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            for (size_t i = 0; i < candidates.size(); ++i)
+                if (!attempt(candidates[i].second, first != nullptr || i > 0))
+                    break;
+        }
+
+        UnhideColumn(col);
+        return found;
+    }
+
+    // Limited discrepancy search restarts with a growing budget, so the solutions closest to the first choices
+    // (in the number of departures from them along the path) come first. Round k only follows paths with exactly k
+    // discrepancies (Korf's improved LDS), the ones with fewer were searched by the rounds before; the depth bound
+    // keeps it from walking those again. A round that did not have to leave any row out found no paths with more,
+    // so the whole tree is searched (a negative limit means no other limit).
+    bool SparseMatrixImp::DiscrepancyImp(int maxDiscrepancies, vector<int>& path, vector<int>& result)
+    {
+        int active = PrepareDepthBound();
+        for (int budget = 0; !mStopRequested.load(memory_order_relaxed); ++budget)
+        {
+            mBudgetCut = false;
+            if (PreferredImp(budget, active, path, result))
+                return true;
+            if (!mBudgetCut || budget == maxDiscrepancies)
+                break;
+        }
+        return false;
+    }
+
+    // Count the primary columns left and find the fewest any row covers, every level of the search covers at
+    // least that many. A column to cover at least once can take a level of its own, so with any of them the bound
+    // is one column per level.
+    int SparseMatrixImp::PrepareDepthBound()
+    {
+        mMinCover = numeric_limits<int>::max();
+        if (find(mColumnAtLeastOnce.begin(), mColumnAtLeastOnce.end(), 1) == mColumnAtLeastOnce.end())
+        {
+            for (SetCell* rowHeader : mRows)
+            {
+                if (rowHeader == nullptr)
+                    continue;
+                int cover = Primary(rowHeader->col);
+                for (auto c : rowHeader->Traverse<SetCell::right>())
+                    cover += Primary(c->col);
+                if (cover > 0)
+                    mMinCover = min(mMinCover, cover);
+            }
+        }
+        if (mMinCover == numeric_limits<int>::max())
+            mMinCover = 1;
+
+        int active = 0;
+        for (SetCell* col = mRoot->Move<SetCell::right>(); col != mRoot; col = col->Move<SetCell::right>())
+            ++active;
+        return active;
+    }
+
+    // Beam over the top levels: every partial solution is kept as its list of cells and applied again when it is
+    // expanded (hiding its column, then covering the row, as the recursive search does). Columns with a single row
+    // left are covered on the way without counting as a level. Children are scored by the
+    // smallest column count left, then by the total, and the best beamWidth of them make the next level. Dead ends
+    // and solutions are noticed right away. The survivors of the last level are finished by depth first search in
+    // the order of their score. Partial solutions dropped from the beam are kept and searched the same way after
+    // that, the latest level first, so every part of the tree is searched once in the end.
+    bool SparseMatrixImp::BeamImp(const SearchOptions& search, vector<int>& path, vector<int>& result)
+    {
+        auto tryRow = [&path](int r) { path.push_back(r); };
+        auto undoRow = [&path](int) { path.pop_back(); };
+        auto apply = [&](const vector<SetCell*>& cells)
+            {
+                for (auto cell : cells)
+                {
+                    HideColumn(mColumns[cell->col]);
+                    Cover(tryRow, cell);
+                }
+            };
+        auto undo = [&](const vector<SetCell*>& cells)
+            {
+                for (auto it = cells.rbegin(); it != cells.rend(); ++it)
+                {
+                    Uncover(undoRow, *it);
+                    UnhideColumn(mColumns[(*it)->col]);
+                }
+            };
+
+        struct Partial
+        {
+            pair<int, int64_t> score;
+            vector<SetCell*> cells;
+        };
+        vector<Partial> beam(1), next;
+        vector<vector<Partial>> dropped;
+        auto better = [](const Partial& a, const Partial& b) { return a.score > b.score; };
+
+        for (int level = 0; level < search.beamDepth && !beam.empty(); ++level)
+        {
+            next.clear();
+            for (auto& partial : beam)
+            {
+                apply(partial.cells);
+                auto col = MostConstrainedColumn();
+                // Forced rows do not take a level, only real choices do
+                while (col != mRoot && col != nullptr && col->counter == 1)
+                {
+                    SetCell* cell = col->Move<SetCell::down>();
+                    HideColumn(col);
+                    Cover(tryRow, cell);
+                    partial.cells.push_back(cell);
+                    col = MostConstrainedColumn();
+                }
+                if (col == mRoot || col == nullptr)
+                {
+                    bool found = col == mRoot;
+                    if (found)
+                    {
+                        SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+                        result = path;
+                    }
+                    undo(partial.cells);
+                    if (found)
+                        return true;
+                    continue;
+                }
+
+                HideColumn(col);
+                for (auto cell : col->Traverse<SetCell::down>())
+                {
+                    Cover(tryRow, cell);
+                    int least = numeric_limits<int>::max();
+                    int64_t total = 0;
+                    for (auto test : mRoot->Traverse<SetCell::right>())
+                    {
+                        least = min(least, test->counter);
+                        total += test->counter;
+                    }
+                    bool solved = mRoot->Move<SetCell::right>() == mRoot;
+                    if (solved)
+                    {
+                        SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+                        result = path;
+                    }
+                    Uncover(undoRow, cell);
+
+                    if (solved)
+                    {
+                        UnhideColumn(col);
+                        undo(partial.cells);
+                        return true;
+                    }
+                    if (least > 0)
+                    {
+                        next.push_back({ { least, total }, partial.cells });
+                        next.back().cells.push_back(cell);
+                    }
+                }
+                UnhideColumn(col);
+                undo(partial.cells);
+
+                if (mStopRequested.load(memory_order_relaxed))
+                    return false;
+            }
+
+            if ((int)next.size() > search.beamWidth)
+            {
+                nth_element(next.begin(), next.begin() + search.beamWidth, next.end(), better);
+                dropped.emplace_back(make_move_iterator(next.begin() + search.beamWidth), make_move_iterator(next.end()));
+                next.resize(search.beamWidth);
+            }
+            swap(beam, next);
+        }
+
+        dropped.push_back(move(beam));
+        for (auto level = dropped.rbegin(); level != dropped.rend(); ++level)
+        {
+            sort(level->begin(), level->end(), better);
+            for (auto& partial : *level)
+            {
+                apply(partial.cells);
+                uint64_t count = 0;
+                CountImp(1, count, path, &result);
+                undo(partial.cells);
+                if (count > 0)
+                    return true;
+                if (mStopRequested.load(memory_order_relaxed))
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool SparseMatrixImp::SolveFirst(vector<int>& solution, const SearchOptions& search)
+    {
+        ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+
+        // Nothing preferred: the first choice in a column is the first row, as in the plain search
+        mRowPreferred.assign(mRows.size(), 0);
+        mColumnPreferred.clear();
+
+        vector<int> path = mSolutionPrefix;
+        bool found = false;
+        switch (search.strategy)
+        {
+        case SearchOptions::depthFirst:
+        {
+            uint64_t count = 0;
+            CountImp(1, count, path, &solution);
+            found = count > 0;
+            break;
+        }
+        case SearchOptions::discrepancy:
+            found = DiscrepancyImp(search.maxDiscrepancies, path, solution);
+            break;
+        case SearchOptions::beam:
+            assert(search.beamWidth > 0);
+            found = BeamImp(search, path, solution);
+            break;
+        }
+
+        state = options;
+        return found;
+    }
+
+    bool SparseMatrixImp::SolveNear(const vector<int>& previous, vector<int>& solution, int maxDiscrepancies)
+    {
+        ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+
+        mRowPreferred.assign(mRows.size(), 0);
+        mColumnPreferred.assign(mColumns.size(), nullptr);
+        for (int r : previous)
+        {
+            assert(r >= 0 && r < (int)mRows.size());
+            mRowPreferred[r] = 1;
+            if (SetCell* rowHeader = mRows[r])
+            {
+                mColumnPreferred[rowHeader->col] = rowHeader;
+                for (auto c : rowHeader->Traverse<SetCell::right>())
+                    mColumnPreferred[c->col] = c;
+            }
+        }
+        // Every level covers a column, so the depth stays below the column count. The buffers are never resized
+        // during the search, the levels keep references to theirs.
+        mCandidates.resize(mColumns.size() + 1);
+
+        vector<int> path = mSolutionPrefix;
+        bool found = maxDiscrepancies < 0 ? PreferredImp(-1, 0, path, solution) : DiscrepancyImp(maxDiscrepancies, path, solution);
+
+        state = options;
+        return found;
+    }
+
+    // The first cover of an at-least-once column takes it out of the column list, the last uncover puts it back
+    void SparseMatrixImp::Satisfy(int c)
+    {
+        if (mCoverage[c]++ == 0)
+            mColumns[c]->RowDetach();
+    }
+
+    void SparseMatrixImp::Unsatisfy(int c)
+    {
+        if (--mCoverage[c] == 0)
+            mColumns[c]->RowRestore();
+    }
+
+    // Take all cells of the row out of their columns (the row is not available any more) and back
+    void SparseMatrixImp::DetachCells(SetCell* cell)
+    {
+        cell->ColumnDetach();
+        --mColumns[cell->col]->counter;
+        for (auto other : cell->Traverse<SetCell::right>())
+        {
+            other->ColumnDetach();
+            --mColumns[other->col]->counter;
+        }
+    }
+
+    void SparseMatrixImp::RestoreCells(SetCell* cell)
+    {
+        for (auto other : cell->Traverse<SetCell::left>())
+        {
+            other->ColumnRestore();
+            ++mColumns[other->col]->counter;
+        }
+        cell->ColumnRestore();
+        ++mColumns[cell->col]->counter;
+    }
+
+    // Cover for SolveMinimum: at-least-once columns of the row are counted as covered, the others are hidden
+    void SparseMatrixImp::CoverMixed(vector<int>& path, SetCell* cell)
+    {
+        path.push_back(cell->row);
+        SolverMetrics::Add(mMetrics.nodes, uint64_t(1));
+        SolverMetrics::Add(mMetrics.depth, 1);
+
+        for (auto test : cell->Traverse<SetCell::right>())
+        {
+            if (AtLeastOnce(test->col))
+                Satisfy(test->col);
+            else
+                HideColumnOf(test);
+        }
+    }
+
+    void SparseMatrixImp::UncoverMixed(vector<int>& path, SetCell* cell)
+    {
+        for (auto test : cell->Traverse<SetCell::left>())
+        {
+            if (AtLeastOnce(test->col))
+                Unsatisfy(test->col);
+            else
+                UnhideColumnOf(test);
+        }
+
+        SolverMetrics::Add(mMetrics.depth, -1);
+        path.pop_back();
+    }
+
+    // Branch and bound over the column with the fewest rows. The bound is the number of columns left to cover
+    // times the lowest cost per column of any row (rounded up for unit costs). An exact column branches as usual;
+    // an at-least-once column is covered by some row in it, branch i takes row i and leaves rows 0..i-1 out, as
+    // solutions with those were seen in the earlier branches. Rows are tried by cost per newly covered column so
+    // that good solutions, and with them tight pruning, come early.
+    void SparseMatrixImp::MinimumImp(double cost, vector<int>& path, MinimumSearch& search)
+    {
+        SetCell* col = mRoot;
+        int open = 0;
+        for (auto test : mRoot->Traverse<SetCell::right>())
+        {
+            if (test->counter == 0)
+                return;
+            ++open;
+            if (test->counter < col->counter)
+                col = test;
+        }
+        if (col == mRoot)
+        {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+            if (cost < search.bestCost)
+            {
+                search.bestCost = cost;
+                search.best = path;
+            }
+            return;
+        }
+
+        double bound = open * search.price;
+        if (search.unit)
+            bound = ceil(bound - 1e-9);
+        if (cost + bound >= search.bestCost - 1e-9)
+            return;
+
+        vector<pair<double, SetCell*>> candidates;
+        for (auto cell : col->Traverse<SetCell::down>())
+        {
+            int covers = 1;
+            for (auto other : cell->Traverse<SetCell::right>())
+            {
+                SetCell* header = mColumns[other->col];
+                if (header->Move<SetCell::left>() != header && header->Move<SetCell::left>()->Move<SetCell::right>() == header)
+                    ++covers;
+            }
+            candidates.emplace_back(search.Cost(cell->row) / covers, cell);
+        }
+        stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        int c = col->Move<SetCell::down>()->col;
+        if (!AtLeastOnce(c))
+        {
+            HideColumn(col);
+            for (auto& candidate : candidates)
+            {
+                CoverMixed(path, candidate.second);
+                MinimumImp(cost + search.Cost(candidate.second->row), path, search);
+                UncoverMixed(path, candidate.second);
+
+                if (mStopRequested.load(memory_order_relaxed))
+                    break;
+            }
+            UnhideColumn(col);
+        }
+        else
+        {
+            Satisfy(c);
+            size_t left = 0;
+            for (; left < candidates.size(); ++left)
+            {
+                SetCell* cell = candidates[left].second;
+                DetachCells(cell);
+                CoverMixed(path, cell);
+                MinimumImp(cost + search.Cost(cell->row), path, search);
+                UncoverMixed(path, cell);
+
+                if (mStopRequested.load(memory_order_relaxed))
+                {
+                    ++left;
+                    break;
+                }
+            }
+            while (left > 0)
+                RestoreCells(candidates[--left].second);
+            Unsatisfy(c);
+        }
+    }
+
+    bool SparseMatrixImp::SolveMinimum(vector<int>& solution, const vector<double>& costs)
+    {
+        ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+        assert(costs.empty() || costs.size() >= mRows.size());
+
+        MinimumSearch search;
+        search.costs = &costs;
+        search.unit = costs.empty();
+        search.price = numeric_limits<double>::infinity();
+        search.bestCost = numeric_limits<double>::infinity();
+        for (int r = 0; r < (int)mRows.size(); ++r)
+        {
+            if (mRows[r] == nullptr)
+                continue;
+            int length = 1;
+            for (SetCell* c = mRows[r]->Move<SetCell::right>(); c != mRows[r]; c = c->Move<SetCell::right>())
+                ++length;
+            search.price = min(search.price, search.Cost(r) / length);
+        }
+
+        // Preselected rows cover their at-least-once columns. Those with no other columns are still in the lists
+        // (nothing was hidden for them) and are taken out so that they are not chosen again.
+        mCoverage.assign(mColumns.size(), 0);
+        mColumnAtLeastOnce.resize(mColumns.size(), 0);
+        vector<SetCell*> detached;
+        double cost = 0;
+        for (int r : mSolutionPrefix)
+        {
+            SetCell* rowHeader = mRows[r];
+            if (rowHeader == nullptr)
+                continue;
+            cost += search.Cost(r);
+            bool onlyAtLeastOnce = AtLeastOnce(rowHeader->col);
+            mCoverage[rowHeader->col] += AtLeastOnce(rowHeader->col);
+            for (auto c : rowHeader->Traverse<SetCell::right>())
+            {
+                onlyAtLeastOnce = onlyAtLeastOnce && AtLeastOnce(c->col);
+                mCoverage[c->col] += AtLeastOnce(c->col);
+            }
+            if (onlyAtLeastOnce)
+            {
+                DetachCells(rowHeader);
+                detached.push_back(rowHeader);
+            }
+        }
+
+        // At-least-once columns still to cover join the column list for the search
+        vector<SetCell*> linked;
+        bool possible = true;
+        for (int c = 0; c < (int)mColumns.size(); ++c)
+        {
+            if (!mColumnAtLeastOnce[c] || mCoverage[c] > 0)
+                continue;
+            if (mColumns[c] == nullptr)
+            {
+                possible = false;
+                continue;
+            }
+            mColumns[c]->InsertBefore(mRoot);
+            linked.push_back(mColumns[c]);
+        }
+
+        vector<int> path = mSolutionPrefix;
+        if (possible)
+            MinimumImp(cost, path, search);
+
+        for (auto it = linked.rbegin(); it != linked.rend(); ++it)
+        {
+            (*it)->RowDetach();
+            (*it)->Orphan();
+        }
+        for (auto it = detached.rbegin(); it != detached.rend(); ++it)
+            RestoreCells(*it);
+
+        state = options;
+        if (search.bestCost == numeric_limits<double>::infinity())
+            return false;
+        solution = search.best;
+        return true;
+    }
+
+    // The generator uses an iterative implementation of the algorith. The issue with the recursive implmentation is that it would
+    // yield a solution from some deeper recursion level meaning that the recursive function itself should be a generator. Calling a
+    // generator is not free and that implementation would incur a significant performance cost.
+    experimental::generator<const vector<int>> SparseMatrixImp::Solve()
+    {
+        ValidateState(solving);
+        mStopRequested.store(false, memory_order_relaxed);
+
+        vector<int> solution;
+
+        auto tryRow = [&solution](int r) { solution.push_back(r); };
+        auto undoRow = [&solution](int r) { solution.pop_back(); };
+
+        for (int p : mSolutionPrefix)
+            tryRow(p);
+
+        auto col = MostConstrainedColumn();
+
+        if (col == mRoot)
+        {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+            co_yield solution;
+        }
+
+        if (col != mRoot && col != nullptr)
+        {
+            // This is the backtracking step. The first element of the pair is the current column header,
+            // the second is the row being tested.
+            vector<pair<SetCell*, SetCell*>> stack;
+
+            stack.push_back(make_pair(col, col));
+            HideColumn(stack.back().first);
+
+            while (true)
+            {
+                // Undo the last step unless we just started with this column
+                if (stack.back().second->row != numeric_limits<int>::max())
+                    Uncover(undoRow, stack.back().second);
+
+                // On request unwind the whole stack, every level below the top has its row covered
+                if (mStopRequested.load(memory_order_relaxed))
+                {
+                    UnhideColumn(stack.back().first);
+                    stack.pop_back();
+                    for (; !stack.empty(); stack.pop_back())
+                    {
+                        Uncover(undoRow, stack.back().second);
+                        UnhideColumn(stack.back().first);
+                    }
+                    break;
+                }
 
                 // Move to the next row
                 auto cell = stack.back().second->Move<SetCell::down>();
@@ -454,6 +2034,7 @@ namespace DancingLinks
                     col = MostConstrainedColumn();
                     if (col == mRoot)
                     {
+                        SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
                         co_yield solution;
                     }
                     else if (col != nullptr)
@@ -472,6 +2053,6 @@ namespace DancingLinks
                 }
             }
         }
-        state = done;
+        state = options;
     }
 }
@@ -4,16 +4,78 @@
 //        https://arxiv.org/pdf/cs/0011047.pdf
 //        https://en.wikipedia.org/wiki/Dancing_Links
 
+#pragma once
+
 #include <vector>
 #include <functional>
+#include <cstdint>
+#include <span>
 
 // Second version of Solve returns all solutions through coroutine
 #include <experimental/generator>
 
+#include "Metrics.h"
+
 namespace DancingLinks
 {
+    // Many solutions stored back to back: solution i is rows[offsets[i], offsets[i + 1])
+    struct SolutionBlock
+    {
+        std::vector<size_t> offsets;
+        std::vector<int> rows;
+
+        size_t Count() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    };
+
+    // Outcome of PreselectRows and ExcludeRow
+    enum class SelectStatus
+    {
+        ok,
+        conflict,   // the rows overlap each other or rows selected before (or are excluded), nothing was selected
+        infeasible, // the rows are selected but some required column cannot be covered any more: no solutions
+    };
+
+    // How a column is to be covered, as set by the SetCondition... calls
+    enum class ColumnKind
+    {
+        exact,          // exactly once (the default)
+        optional,       // at most once
+        atLeastOnce,    // see SetConditionAtLeastOnce
+        capacity,       // by up to its capacity of rows, see SetConditionCapacity
+    };
+
+    // How SolveFirst looks for a solution. Depth first search is the plain one and commits to its first choices
+    // for good; on large instances an early wrong choice can cost the whole run. Limited discrepancy search runs
+    // rounds taking exactly 0, 1, 2, ... choices other than the first one along a path, so solutions differing
+    // from the first choices in a few places are found early and no round repeats the paths of the one before.
+    // The rounds go on until one finds a solution or is not cut short by its allowance, so the search is
+    // complete; maxDiscrepancies >= 0 stops after that round instead and then a failure can also mean the limit
+    // was reached. Beam search expands the top beamDepth levels breadth
+    // first, keeping the beamWidth partial solutions with the largest smallest column count, then finishes the
+    // survivors depth first and after them the partial solutions it dropped, so it is complete too.
+    struct SearchOptions
+    {
+        enum Strategy { depthFirst, discrepancy, beam };
+        Strategy strategy = depthFirst;
+        int maxDiscrepancies = -1;
+        int beamWidth = 16;
+        int beamDepth = 8;
+    };
+
+    // How the search takes back hidden columns. Relinking walks the column and its rows again in reverse, chasing
+    // the same pointers as hiding did. With the trail every cell taken out is also appended to a log while hiding,
+    // and undoing replays the log backwards, reading it sequentially. The links written are the same either way.
+    enum class UndoMode
+    {
+        relink,
+        trail,
+    };
+
     class SparseMatrix
     {
+    protected:
+        virtual ~SparseMatrix() = default;
+
     public:
         // The solver has to be acquired through Create and disposed of using Destroy
         static SparseMatrix* Create();
@@ -22,15 +84,92 @@ namespace DancingLinks
         // Set constraint condition. In the final solution all conditions must be satisfied by exactly one row
         // except for conditions marked as optional - those must be satisfied at most by one row.
         virtual void SetCondition(int c, int r) = 0;
+        // Bulk alternative to SetCondition for large matrices: generator is called once for every row in [0, rowCount)
+        // and fills in the columns of that row. Rows are generated and linked on several threads (generator has to be
+        // thread-safe), threads <= 0 means one per core. Only valid on an empty matrix.
+        virtual void BuildRows(int rowCount, std::function<void(int, std::vector<int>&)> generator, int threads = 0) = 0;
         // Set condition to optional state so it is not required to be satisfied but still checks for conflicts.
         // Note that all conditions need to be set before marking any as optional.
         virtual void SetConditionOptional(int c) = 0;
+        // Set condition to at-least-once state: one or more rows have to satisfy it (set cover rather than exact
+        // cover). Only SolveMinimum takes these into account, the exact cover solvers treat them as optional.
+        // Preselected rows may share them. Same rules as for optional conditions otherwise.
+        virtual void SetConditionAtLeastOnce(int c) = 0;
+        // Set condition to hold up to capacity rows instead of one (at most; capacity 1 is just optional). The rows
+        // using it are counted, so a selection is found once whichever rows share the column. Same rules as for
+        // optional conditions otherwise.
+        virtual void SetConditionCapacity(int c, int capacity) = 0;
         // Mark row as required part of the solution. All conditions need to be set before calling this.
         virtual void PreselectRow(int r) = 0;
+        // Mark many rows at once, checking them first: rows sharing a column with each other or with rows selected
+        // earlier are reported as a conflict instead of corrupting the matrix. Rows already selected are skipped.
+        // Takes time proportional to the rows and the columns they hide. PreselectRow is the same for one row.
+        virtual SelectStatus PreselectRows(std::span<const int> rows) = 0;
+        // Take back the most recently preselected row (preselections are undone in reverse order, rows selected
+        // together one by one from the last). Together with PreselectRow this allows solving many variations of
+        // one matrix without building it again.
+        virtual void UnselectRow(int r) = 0;
+        // Preselected rows, in the order they were selected (valid until the selection changes)
+        virtual std::span<const int> SelectedRows() const = 0;
+        // Keep the row out of solutions. Excluding a preselected row is a conflict; a required column left without
+        // rows makes it infeasible (the row is excluded anyway). RestoreRow takes back the most recent exclusion;
+        // exclusions and preselections are undone together in reverse order, and an excluded row cannot be
+        // preselected.
+        virtual SelectStatus ExcludeRow(int r) = 0;
+        virtual void RestoreRow(int r) = 0;
+
+        // Rows are numbered [0, RowCount()). The columns of a row in no particular order (none for a row that was
+        // never set), whatever is selected or excluded. Not valid while solving. Columns never set otherwise are
+        // exact ones.
+        virtual int RowCount() const = 0;
+        virtual void RowColumns(int r, std::vector<int>& columns) const = 0;
+        virtual ColumnKind ColumnKindOf(int c) const = 0;
+
+        // Independent copy of the matrix with the same rows, optional columns, preselected and excluded rows, e.g.
+        // one per thread. Not valid while solving. Release it with Destroy.
+        virtual SparseMatrix* Clone() const = 0;
+
+        // Choose how columns hidden by the search are restored (see UndoMode), relinking by default. Applies to all
+        // solvers; preselection and exclusion always relink. Not valid while solving.
+        virtual void SetUndoMode(UndoMode mode) = 0;
 
         // Two different ways to generate solution - the first one will use callbacks when trying and undoing rows, and on complete. The second
         // one will just produce the sequence of solutions via coroutine.
         virtual void Solve(std::function<void(int)> tryRow, std::function<void(int)> undoRow, std::function<void()> complete) = 0;
         virtual std::experimental::generator<const std::vector<int>> Solve() = 0;
+        // Third way for problems with huge numbers of solutions: solutions are collected into blocks of blockSize
+        // and every full block (and the last partial one) is handed to the consumer. The block is reused afterwards,
+        // copy what needs to be kept.
+        virtual void SolveBlocks(std::function<void(const SolutionBlock&)> consumer, size_t blockSize = 65536) = 0;
+        // SolveBlocks on several threads with the solutions still in exactly the sequential order. The search tree
+        // is split a few levels down into subtrees, taken in order by the threads, each working on its own copy of
+        // the matrix. The consumer is called on the calling thread, subtree by subtree; the ones finished ahead of
+        // their turn wait in buffers, and when a few blocks per thread are waiting the threads pause. Blocks end
+        // with their subtree so they can be shorter than blockSize. threads <= 0 means one per core.
+        virtual void SolveParallel(std::function<void(const SolutionBlock&)> consumer, int threads = 0, size_t blockSize = 65536) = 0;
+        // Count solutions, stopping as soon as limit is reached (limit 2 is a uniqueness check). The first solution
+        // found is stored if requested. Unlike abandoning the generator early this leaves the matrix intact.
+        // After any solve runs to the end the matrix can be solved again, with different preselected rows if needed.
+        virtual uint64_t Count(uint64_t limit = UINT64_MAX, std::vector<int>* firstSolution = nullptr) = 0;
+        // Find one solution with the given strategy (see SearchOptions). Returns false if none was found.
+        virtual bool SolveFirst(std::vector<int>& solution, const SearchOptions& search = {}) = 0;
+        // Fewest rows (or with costs, one per row, the cheapest rows) satisfying every condition: required ones
+        // exactly once, optional ones at most once and at-least-once ones at least once. Preselected rows are part
+        // of it. Branch and bound, the time can grow quickly with the size. Returns false if there is no solution.
+        virtual bool SolveMinimum(std::vector<int>& solution, const std::vector<double>& costs = {}) = 0;
+        // Find one solution close to an earlier one, e.g. after rows were excluded or preselected since: the rows of
+        // previous are tried first in every column, so the parts that still fit are kept and only the rest is
+        // searched. With maxDiscrepancies >= 0 this is limited discrepancy search - taking any row but the first
+        // choice of a column counts as a discrepancy, and rounds allowing 0, 1, ... maxDiscrepancies of them along
+        // a path are run until one finds a solution. Returns false if there is none (within the limit).
+        virtual bool SolveNear(const std::vector<int>& previous, std::vector<int>& solution, int maxDiscrepancies = -1) = 0;
+
+        // Ask the running solve (any of the above) to return early. Can be called from the callbacks or from another
+        // thread. The search unwinds as usual so the matrix stays usable; the request is cleared when a solve starts.
+        virtual void Stop() = 0;
+
+        // Live counters of the solver (nodes, solutions, depth, memory). Safe to read from another thread while
+        // solving, e.g. through MetricsExporter.
+        virtual const SolverMetrics& Metrics() const = 0;
     };
 }
@@ -0,0 +1,215 @@
+// DancingLinksC.cpp
+// C interface to the solver
+
+#include <vector>
+#include <new>
+#include <algorithm>
+
+#include "DancingLinksC.h"
+#include "DancingLinks.h"
+
+using namespace std;
+using namespace DancingLinks;
+
+// The C++ side validates calls with asserts, here invalid calls have to come back as status codes instead, so the
+// handle keeps enough state to check them upfront.
+struct dlx_matrix
+{
+    SparseMatrix* dlx = nullptr;
+    bool built = false;
+    int rowCount = 0;
+    int columnCount = 0;
+    vector<char> selected;  // per row
+    vector<int> selection;  // preselected rows in order
+};
+
+dlx_matrix* dlx_create(void)
+{
+    dlx_matrix* matrix = new (nothrow) dlx_matrix;
+    if (matrix)
+        matrix->dlx = SparseMatrix::Create();
+    return matrix;
+}
+
+void dlx_destroy(dlx_matrix* matrix)
+{
+    if (matrix)
+    {
+        SparseMatrix::Destroy(matrix->dlx);
+        delete matrix;
+    }
+}
+
+int dlx_build_csr(dlx_matrix* matrix, int row_count, const size_t* offsets, const int* columns, int threads)
+{
+    if (!matrix || row_count < 0 || !offsets || (!columns && offsets[row_count] > 0))
+        return DLX_INVALID_ARGUMENT;
+    if (matrix->built)
+        return DLX_INVALID_STATE;
+
+    int columnCount = 0;
+    for (int r = 0; r < row_count; ++r)
+    {
+        if (offsets[r] > offsets[r + 1])
+            return DLX_INVALID_ARGUMENT;
+        for (size_t i = offsets[r]; i < offsets[r + 1]; ++i)
+        {
+            if (columns[i] < 0)
+                return DLX_INVALID_ARGUMENT;
+            if (columns[i] >= columnCount)
+                columnCount = columns[i] + 1;
+        }
+    }
+
+    try
+    {
+        matrix->dlx->BuildRows(row_count, [offsets, columns](int r, vector<int>& row)
+            {
+                row.assign(columns + offsets[r], columns + offsets[r + 1]);
+            }, threads);
+        matrix->selected.assign(row_count, 0);
+    }
+    catch (const bad_alloc&)
+    {
+        return DLX_OUT_OF_MEMORY;
+    }
+
+    matrix->built = true;
+    matrix->rowCount = row_count;
+    matrix->columnCount = columnCount;
+    return DLX_OK;
+}
+
+int dlx_set_optional(dlx_matrix* matrix, int column)
+{
+    if (!matrix || column < 0)
+        return DLX_INVALID_ARGUMENT;
+    if (!matrix->built || !matrix->selection.empty())
+        return DLX_INVALID_STATE;
+
+    // Columns no row uses do not exist in the matrix, there is nothing to relax
+    if (column < matrix->columnCount)
+        matrix->dlx->SetConditionOptional(column);
+    return DLX_OK;
+}
+
+int dlx_preselect(dlx_matrix* matrix, int row)
+{
+    return dlx_preselect_rows(matrix, &row, 1);
+}
+
+int dlx_preselect_rows(dlx_matrix* matrix, const int* rows, size_t count)
+{
+    if (!matrix || (!rows && count > 0))
+        return DLX_INVALID_ARGUMENT;
+    if (!matrix->built)
+        return DLX_INVALID_STATE;
+    for (size_t i = 0; i < count; ++i)
+        if (rows[i] < 0 || rows[i] >= matrix->rowCount)
+            return DLX_INVALID_ARGUMENT;
+
+    SelectStatus status = matrix->dlx->PreselectRows({ rows, count });
+    if (status == SelectStatus::conflict)
+        return DLX_CONFLICT;
+
+    // Same order and the same skipping of repeated rows as the matrix, so unselecting stays in step
+    for (size_t i = 0; i < count; ++i)
+        if (!matrix->selected[rows[i]])
+        {
+            matrix->selected[rows[i]] = 1;
+            matrix->selection.push_back(rows[i]);
+        }
+    return status == SelectStatus::infeasible ? DLX_INFEASIBLE : DLX_OK;
+}
+
+int dlx_unselect(dlx_matrix* matrix, int row)
+{
+    if (!matrix)
+        return DLX_INVALID_ARGUMENT;
+    if (matrix->selection.empty() || matrix->selection.back() != row)
+        return DLX_INVALID_STATE;
+
+    matrix->dlx->UnselectRow(row);
+    matrix->selected[row] = 0;
+    matrix->selection.pop_back();
+    return DLX_OK;
+}
+
+int dlx_solve(dlx_matrix* matrix, size_t* offsets, size_t max_solutions, int* rows, size_t max_rows,
+    dlx_block_callback callback, void* context, uint64_t* solution_count)
+{
+    if (!matrix || !offsets || max_solutions == 0 || (!rows && max_rows > 0) || !callback)
+        return DLX_INVALID_ARGUMENT;
+    if (!matrix->built)
+        return DLX_INVALID_STATE;
+
+    // The partial solution lives in a scratch vector that never grows past the row count, complete solutions are
+    // copied once into the caller's buffer and nowhere else
+    vector<int> path;
+    size_t count = 0;   // solutions in the current block
+    uint64_t total = 0;
+    int status = DLX_OK;
+    offsets[0] = 0;
+
+    try
+    {
+        // Solve reports the preselected rows through tryRow first, the path starts empty
+        path.reserve(matrix->rowCount);
+
+        auto flush = [&]()
+            {
+                total += count;
+                if (callback(context, count, offsets, rows) != 0)
+                {
+                    status = DLX_STOPPED;
+                    matrix->dlx->Stop();
+                }
+                count = 0;
+            };
+
+        matrix->dlx->Solve([&path](int r) { path.push_back(r); }, [&path](int) { path.pop_back(); }, [&]()
+            {
+                if (status != DLX_OK)
+                    return;
+                if (path.size() > max_rows)
+                {
+                    status = DLX_BUFFER_TOO_SMALL;
+                    matrix->dlx->Stop();
+                    return;
+                }
+                if (offsets[count] + path.size() > max_rows)
+                {
+                    flush();
+                    if (status != DLX_OK)
+                        return;
+                }
+
+                copy(path.begin(), path.end(), rows + offsets[count]);
+                offsets[count + 1] = offsets[count] + path.size();
+                if (++count == max_solutions)
+                    flush();
+            });
+
+        if (status == DLX_OK && count > 0)
+            flush();
+    }
+    catch (const bad_alloc&)
+    {
+        status = DLX_OUT_OF_MEMORY;
+    }
+
+    if (solution_count)
+        *solution_count = total;
+    return status;
+}
+
+int dlx_count(dlx_matrix* matrix, uint64_t limit, uint64_t* solution_count)
+{
+    if (!matrix || !solution_count)
+        return DLX_INVALID_ARGUMENT;
+    if (!matrix->built)
+        return DLX_INVALID_STATE;
+
+    *solution_count = matrix->dlx->Count(limit == 0 ? UINT64_MAX : limit);
+    return DLX_OK;
+}
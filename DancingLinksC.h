@@ -0,0 +1,67 @@
+/* DancingLinksC.h
+ * C interface to the solver for use from other languages (Python ctypes/cffi, Go cgo, ...). The functions only
+ * take plain pointers and integers and never allocate memory that the caller has to release, solutions are written
+ * straight into buffers owned by the caller.
+ */
+
+#ifndef DANCING_LINKS_C_H
+#define DANCING_LINKS_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(DLX_EXPORTS)
+#    define DLX_API __declspec(dllexport)
+#  else
+#    define DLX_API
+#  endif
+#else
+#  define DLX_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Status codes */
+#define DLX_OK              0
+#define DLX_STOPPED         1   /* the block callback asked to stop */
+#define DLX_INFEASIBLE      2   /* rows preselected, but there can be no solution */
+#define DLX_INVALID_ARGUMENT (-1)
+#define DLX_INVALID_STATE   (-2) /* e.g. building twice or setting options after solving */
+#define DLX_BUFFER_TOO_SMALL (-3) /* a single solution does not fit in the row buffer */
+#define DLX_OUT_OF_MEMORY   (-4)
+#define DLX_CONFLICT        (-5) /* preselected rows overlap, nothing was selected */
+
+typedef struct dlx_matrix dlx_matrix;
+
+/* Called with the solutions written so far: solution i is rows[offsets[i], offsets[i + 1]), offsets[0] is 0. These
+ * are the caller's own buffers, reused for the next block once the callback returns. Return nonzero to stop. */
+typedef int (*dlx_block_callback)(void* context, size_t solution_count, const size_t* offsets, const int* rows);
+
+DLX_API dlx_matrix* dlx_create(void);
+DLX_API void dlx_destroy(dlx_matrix* matrix);
+
+/* Build the whole matrix from compressed rows: row r has the columns columns[offsets[r], offsets[r + 1]).
+ * threads <= 0 means one per core. Can be called once, before anything else. */
+DLX_API int dlx_build_csr(dlx_matrix* matrix, int row_count, const size_t* offsets, const int* columns, int threads);
+/* Same meaning as SetConditionOptional, PreselectRow(s) and UnselectRow of the C++ interface */
+DLX_API int dlx_set_optional(dlx_matrix* matrix, int column);
+DLX_API int dlx_preselect(dlx_matrix* matrix, int row);
+DLX_API int dlx_preselect_rows(dlx_matrix* matrix, const int* rows, size_t count);
+DLX_API int dlx_unselect(dlx_matrix* matrix, int row);
+
+/* Enumerate solutions into the caller's buffers: offsets has room for max_solutions + 1 entries, rows for max_rows.
+ * The callback gets every full block and the last partial one. The total number of solutions delivered is stored
+ * in solution_count if not NULL. */
+DLX_API int dlx_solve(dlx_matrix* matrix, size_t* offsets, size_t max_solutions, int* rows, size_t max_rows,
+    dlx_block_callback callback, void* context, uint64_t* solution_count);
+/* Count solutions up to limit (0 for no limit) */
+DLX_API int dlx_count(dlx_matrix* matrix, uint64_t limit, uint64_t* solution_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,24 @@
+// ExactCoverProblem.h
+// Plain description of an exact cover problem, no solver needed to include it
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+
+namespace DancingLinks
+{
+    // The problem as a list of rows, each row a list of columns. Columns [0, primaryCount) have to be covered
+    // exactly once, the rest (secondary) at most once. This is the common input for all the solvers.
+    struct ExactCoverProblem
+    {
+        int columnCount = 0;
+        int primaryCount = 0;
+        std::vector<std::vector<int>> rows;
+        // Secondary columns that up to that many rows can share, as (column, capacity) pairs
+        std::vector<std::pair<int, int>> capacities;
+        // Names of the columns when read from text, empty otherwise
+        std::vector<std::string> columnNames;
+    };
+}
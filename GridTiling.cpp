@@ -0,0 +1,270 @@
+// GridTiling.cpp
+// Counting exact covers of grid structured problems
+
+#include <assert.h>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+
+#include "GridTiling.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    // Set of cells as a bitset, used as a hash key
+    typedef vector<uint64_t> CellSet;
+
+    struct CellSetHash
+    {
+        size_t operator()(const CellSet& s) const
+        {
+            uint64_t h = 0x9e3779b97f4a7c15ull;
+            for (auto w : s)
+                h = (h ^ w) * 0xff51afd7ed558ccdull;
+            return size_t(h ^ (h >> 32));
+        }
+    };
+
+    static uint64_t PieceMask(const GridProblem& problem, const vector<int>& placement)
+    {
+        int cells = problem.width * problem.height;
+        for (int c : placement)
+            if (c >= cells)
+                return uint64_t(1) << (c - cells);
+        return 0;
+    }
+
+    static uint64_t AllPieces(const GridProblem& problem)
+    {
+        return problem.pieceCount >= 64 ? ~uint64_t(0) : (uint64_t(1) << problem.pieceCount) - 1;
+    }
+
+    // Build a matrix out of a subset of placements. Cells outside [firstRequired, endRequired) and pieces
+    // become optional columns (whether all pieces are used is checked when joining the halves). Returns nullptr
+    // if some required cell cannot be covered at all: such a column would not even exist in the matrix and the
+    // solver would happily ignore it.
+    static SparseMatrix* BuildPart(const GridProblem& problem, const vector<const vector<int>*>& rows, int firstRequired, int endRequired, const CellSet* blocked)
+    {
+        int cells = problem.width * problem.height;
+        vector<char> used(cells + problem.pieceCount, 0);
+        for (auto row : rows)
+            for (int c : *row)
+                used[c] = 1;
+        for (int c = firstRequired; c < endRequired; ++c)
+            if (!used[c] && !(blocked && ((*blocked)[(c - firstRequired) >> 6] >> ((c - firstRequired) & 63) & 1)))
+                return nullptr;
+
+        // One matrix is built per boundary and most are tiny, starting threads for each would cost more than the build
+        SparseMatrix* dlx = SparseMatrix::Create();
+        dlx->BuildRows((int)rows.size(), [&rows](int r, vector<int>& columns) { columns = *rows[r]; }, 1);
+        for (int c = 0; c < cells + problem.pieceCount; ++c)
+            if (used[c] && (c < firstRequired || c >= endRequired))
+                dlx->SetConditionOptional(c);
+        return dlx;
+    }
+
+    void BuildMatrix(const GridProblem& problem, SparseMatrix* dlx)
+    {
+        dlx->BuildRows((int)problem.placements.size(), [&problem](int r, vector<int>& columns) { columns = problem.placements[r]; });
+        if (!problem.piecesRequired)
+        {
+            // Only columns that exist can be made optional
+            vector<char> used(problem.pieceCount, 0);
+            int cells = problem.width * problem.height;
+            for (auto& placement : problem.placements)
+                for (int c : placement)
+                    if (c >= cells)
+                        used[c - cells] = 1;
+            for (int p = 0; p < problem.pieceCount; ++p)
+                if (used[p])
+                    dlx->SetConditionOptional(cells + p);
+        }
+    }
+
+    uint64_t CountTilingsSplit(const GridProblem& problem)
+    {
+        assert(problem.pieceCount >= 0 && problem.pieceCount <= 64);
+
+        int cells = problem.width * problem.height;
+        int split = (problem.width / 2) * problem.height; // first cell of the right half
+        int rightCells = cells - split;
+        uint64_t allPieces = AllPieces(problem);
+
+        // Placements are assigned to the half containing their first cell
+        vector<const vector<int>*> left, right;
+        for (auto& placement : problem.placements)
+        {
+            int first = cells;
+            for (int c : placement)
+                if (c < first)
+                    first = c;
+            if (first < split)
+                left.push_back(&placement);
+            else if (first < cells)
+                right.push_back(&placement);
+        }
+
+        // Step 1: enumerate left half fillings keyed by the right half cells they occupy and the pieces used
+        unordered_map<CellSet, unordered_map<uint64_t, uint64_t>, CellSetHash> leftTable;
+        {
+            SparseMatrix* dlx = BuildPart(problem, left, 0, split, nullptr);
+            if (dlx == nullptr)
+                return 0;
+
+            // The signature is maintained incrementally as rows are tried and undone (xor works both ways)
+            CellSet boundary((rightCells + 63) / 64, 0);
+            uint64_t pieces = 0;
+            auto toggle = [&](int r)
+                {
+                    for (int c : *left[r])
+                        if (c >= split && c < cells)
+                            boundary[(c - split) >> 6] ^= uint64_t(1) << ((c - split) & 63);
+                    pieces ^= PieceMask(problem, *left[r]);
+                };
+            dlx->Solve(toggle, toggle, [&]() { ++leftTable[boundary][pieces]; });
+            SparseMatrix::Destroy(dlx);
+        }
+
+        // Step 2: for every distinct boundary tile the rest of the right half and join on the piece sets
+        uint64_t total = 0;
+        unordered_map<uint64_t, uint64_t> rightCounts;
+        vector<const vector<int>*> rows;
+        for (auto& entry : leftTable)
+        {
+            const CellSet& boundary = entry.first;
+
+            rows.clear();
+            for (auto row : right)
+            {
+                bool fits = true;
+                for (int c : *row)
+                    if (c < cells && (boundary[(c - split) >> 6] >> ((c - split) & 63) & 1))
+                    {
+                        fits = false;
+                        break;
+                    }
+                if (fits)
+                    rows.push_back(row);
+            }
+
+            // A right half completely filled from the left is a valid (empty) right side as well
+            bool full = true;
+            for (int c = 0; c < rightCells; ++c)
+                if (!(boundary[c >> 6] >> (c & 63) & 1))
+                {
+                    full = false;
+                    break;
+                }
+
+            rightCounts.clear();
+            if (full)
+                rightCounts[0] = 1;
+            else if (SparseMatrix* dlx = BuildPart(problem, rows, split, cells, &boundary))
+            {
+                uint64_t pieces = 0;
+                auto toggle = [&](int r) { pieces ^= PieceMask(problem, *rows[r]); };
+                dlx->Solve(toggle, toggle, [&]() { ++rightCounts[pieces]; });
+                SparseMatrix::Destroy(dlx);
+            }
+
+            for (auto& l : entry.second)
+            {
+                if (problem.piecesRequired)
+                {
+                    auto r = rightCounts.find(allPieces & ~l.first);
+                    if (r != rightCounts.end())
+                        total += l.second * r->second;
+                }
+                else
+                {
+                    for (auto& r : rightCounts)
+                        if ((l.first & r.first) == 0)
+                            total += l.second * r.second;
+                }
+            }
+        }
+
+        return total;
+    }
+
+    uint64_t CountTilingsSweep(const GridProblem& problem)
+    {
+        assert(problem.pieceCount >= 0 && problem.pieceCount <= 64);
+
+        int cells = problem.width * problem.height;
+
+        // Placements grouped by their first cell, cells as a bit mask relative to that cell
+        struct Shape
+        {
+            uint64_t cells;
+            uint64_t piece;
+        };
+        vector<vector<Shape>> starting(cells);
+        for (auto& placement : problem.placements)
+        {
+            int first = cells, last = -1;
+            for (int c : placement)
+                if (c < cells)
+                {
+                    first = min(first, c);
+                    last = max(last, c);
+                }
+            if (last < 0)
+                continue;
+            assert(last - first < 64);
+
+            Shape shape = { 0, PieceMask(problem, placement) };
+            for (int c : placement)
+                if (c < cells)
+                    shape.cells |= uint64_t(1) << (c - first);
+            starting[first].push_back(shape);
+        }
+
+        // Frontier state: bit k of occupied is cell (current + k)
+        struct State
+        {
+            uint64_t occupied;
+            uint64_t pieces;
+            bool operator==(const State& other) const { return occupied == other.occupied && pieces == other.pieces; }
+        };
+        struct StateHash
+        {
+            size_t operator()(const State& s) const
+            {
+                uint64_t h = (s.occupied ^ (s.pieces * 0x9e3779b97f4a7c15ull)) * 0xff51afd7ed558ccdull;
+                return size_t(h ^ (h >> 32));
+            }
+        };
+
+        unordered_map<State, uint64_t, StateHash> current, next;
+        current[{ 0, 0 }] = 1;
+
+        for (int cell = 0; cell < cells; ++cell)
+        {
+            next.clear();
+            for (auto& entry : current)
+            {
+                const State& state = entry.first;
+                if (state.occupied & 1)
+                {
+                    next[{ state.occupied >> 1, state.pieces }] += entry.second;
+                    continue;
+                }
+
+                for (auto& shape : starting[cell])
+                    if ((shape.cells & state.occupied) == 0 && (shape.piece & state.pieces) == 0)
+                        next[{ (state.occupied | shape.cells) >> 1, state.pieces | shape.piece }] += entry.second;
+            }
+            swap(current, next);
+        }
+
+        uint64_t allPieces = AllPieces(problem);
+        uint64_t total = 0;
+        for (auto& entry : current)
+            if (entry.first.occupied == 0 && (!problem.piecesRequired || entry.first.pieces == allPieces))
+                total += entry.second;
+        return total;
+    }
+}
@@ -0,0 +1,43 @@
+// GridTiling.h
+// Counting exact covers of grid structured problems (polyomino and domino tilings)
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "DancingLinks.h"
+
+namespace DancingLinks
+{
+    // Tiling of a width x height rectangle. Every placement is a row of the exact cover problem: a list of the
+    // cells it covers plus at most one piece item. Cells are numbered column by column, cell (x, y) is
+    // x * height + y, and piece p is the item width * height + p. There can be up to 64 pieces; with no pieces
+    // at all (e.g. dominoes) every placement can be used any number of times.
+    struct GridProblem
+    {
+        int width = 0;
+        int height = 0;
+        int pieceCount = 0;
+        // Every piece has to be used exactly once, otherwise at most once
+        bool piecesRequired = true;
+        std::vector<std::vector<int>> placements;
+    };
+
+    // Load the problem into an empty matrix (row numbers are placement indices)
+    void BuildMatrix(const GridProblem& problem, SparseMatrix* dlx);
+
+    // Meet in the middle: the board is split into left and right halves. All partial tilings covering the left half
+    // (placements starting there may stick out to the right) are enumerated once and grouped by their boundary
+    // signature - the right half cells they occupy and the pieces they use. The right half is then tiled once per
+    // distinct boundary and the two sides are joined through a hash lookup on the complementary piece set. Each
+    // half is a much smaller search than the whole board at the cost of keeping the left table in memory.
+    uint64_t CountTilingsSplit(const GridProblem& problem);
+
+    // Transfer matrix: the board is swept cell by cell in numbering order (column by column) keeping a table from
+    // frontier state to the number of partial tilings reaching it. The state is the occupancy of the cells ahead of
+    // the sweep that placements already stick into plus the set of pieces used. Every cell is either already
+    // occupied or gets the placements starting at it, so the work grows linearly with the board length for a
+    // fixed height. Placements must not span more than 64 consecutive cells (e.g. pentominoes up to height 15).
+    uint64_t CountTilingsSweep(const GridProblem& problem);
+}
@@ -0,0 +1,338 @@
+// ImplicitMatrix.cpp
+// Algorithm X over a matrix given by callbacks, coverage is kept in bitsets
+
+#include <assert.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <bit>
+#include <experimental/generator>
+
+#include "ImplicitMatrix.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    class ImplicitMatrixImp final : public ImplicitMatrix
+    {
+    private:
+        int mColumnCount;
+        RowsOfColumn mRowsOfColumn;
+        ColumnsOfRow mColumnsOfRow;
+
+        // One bit per column. Covered columns are those satisfied by one of the selected rows, optional columns
+        // do not need to be covered but still cannot be covered twice.
+        std::vector<uint64_t> mCovered;
+        std::vector<uint64_t> mOptional;
+        // Number of required columns not covered yet, zero means a solution
+        int mRemaining;
+
+        std::vector<int64_t> mSolutionPrefix;
+
+        // Search level: the column being satisfied, its compatible rows and the position in that list. The levels
+        // are kept between calls so the vectors keep their capacity and the search does not allocate once warmed up.
+        struct Level
+        {
+            int column = -1;
+            std::vector<int64_t> candidates;
+            size_t next = 0;
+            int64_t row = -1;
+        };
+        std::vector<Level> mLevels;
+        // Scratch buffers for the callbacks
+        std::vector<int64_t> mScanRows;
+        std::vector<int64_t> mCompatible;
+        std::vector<int> mScanColumns;
+
+        SolverMetrics mMetrics;
+        void UpdateMemoryMetric();
+
+        enum State { init, options, solving };
+        State state;
+        void ValidateState(State s);
+
+        bool Test(const std::vector<uint64_t>& bits, int c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+        void Flip(std::vector<uint64_t>& bits, int c) { bits[c >> 6] ^= uint64_t(1) << (c & 63); }
+
+        bool Compatible(int64_t r);
+        void Cover(int64_t r);
+        void Uncover(int64_t r);
+        bool MostConstrainedColumn(Level& level);
+
+        void SolveImp(size_t depth, std::function<void(int64_t)>& tryRow, std::function<void(int64_t)>& undoRow, std::function<void()>& complete);
+
+    public:
+        ImplicitMatrixImp(int columnCount, RowsOfColumn rowsOfColumn, ColumnsOfRow columnsOfRow);
+        ImplicitMatrixImp(const ImplicitMatrixImp&) = delete;
+        ImplicitMatrixImp(ImplicitMatrixImp&&) = delete;
+
+        virtual void SetConditionOptional(int c) override;
+        virtual void PreselectRow(int64_t r) override;
+
+        virtual void Solve(std::function<void(int64_t)> tryRow, std::function<void(int64_t)> undoRow, std::function<void()> complete) override;
+        virtual std::experimental::generator<const std::vector<int64_t>> Solve() override;
+
+        virtual const SolverMetrics& Metrics() const override;
+    };
+
+    ImplicitMatrix* ImplicitMatrix::Create(int columnCount, RowsOfColumn rowsOfColumn, ColumnsOfRow columnsOfRow)
+    {
+        return new ImplicitMatrixImp(columnCount, rowsOfColumn, columnsOfRow);
+    }
+
+    void ImplicitMatrix::Destroy(ImplicitMatrix* ptr)
+    {
+        delete ptr;
+    }
+
+    ImplicitMatrixImp::ImplicitMatrixImp(int columnCount, RowsOfColumn rowsOfColumn, ColumnsOfRow columnsOfRow) :
+        mColumnCount(columnCount), mRowsOfColumn(rowsOfColumn), mColumnsOfRow(columnsOfRow)
+    {
+        assert(columnCount >= 0);
+        mCovered.resize((columnCount + 63) / 64, 0);
+        mOptional.resize((columnCount + 63) / 64, 0);
+        mRemaining = columnCount;
+        state = init;
+        UpdateMemoryMetric();
+    }
+
+    void ImplicitMatrixImp::ValidateState(State s)
+    {
+        assert(state <= s);
+        state = s;
+    }
+
+    void ImplicitMatrixImp::UpdateMemoryMetric()
+    {
+        size_t bytes = sizeof(ImplicitMatrixImp) + (mCovered.capacity() + mOptional.capacity()) * sizeof(uint64_t) +
+            (mScanRows.capacity() + mCompatible.capacity() + mSolutionPrefix.capacity()) * sizeof(int64_t) + mScanColumns.capacity() * sizeof(int);
+        for (auto& level : mLevels)
+            bytes += sizeof(Level) + level.candidates.capacity() * sizeof(int64_t);
+        mMetrics.memoryBytes.store(bytes, memory_order_relaxed);
+    }
+
+    const SolverMetrics& ImplicitMatrixImp::Metrics() const
+    {
+        return mMetrics;
+    }
+
+    void ImplicitMatrixImp::SetConditionOptional(int c)
+    {
+        ValidateState(options);
+        assert(c >= 0 && c < mColumnCount);
+
+        if (!Test(mOptional, c))
+        {
+            Flip(mOptional, c);
+            if (!Test(mCovered, c))
+                --mRemaining;
+        }
+    }
+
+    void ImplicitMatrixImp::PreselectRow(int64_t r)
+    {
+        ValidateState(options);
+
+        if (std::find(mSolutionPrefix.begin(), mSolutionPrefix.end(), r) == mSolutionPrefix.end())
+        {
+            assert(Compatible(r)); // preselected rows cannot overlap
+            Cover(r);
+            mSolutionPrefix.push_back(r);
+        }
+    }
+
+    bool ImplicitMatrixImp::Compatible(int64_t r)
+    {
+        mScanColumns.clear();
+        mColumnsOfRow(r, mScanColumns);
+        for (int c : mScanColumns)
+            if (Test(mCovered, c))
+                return false;
+        return true;
+    }
+
+    void ImplicitMatrixImp::Cover(int64_t r)
+    {
+        mScanColumns.clear();
+        mColumnsOfRow(r, mScanColumns);
+        for (int c : mScanColumns)
+        {
+            assert(c >= 0 && c < mColumnCount && !Test(mCovered, c));
+            Flip(mCovered, c);
+            if (!Test(mOptional, c))
+                --mRemaining;
+        }
+    }
+
+    void ImplicitMatrixImp::Uncover(int64_t r)
+    {
+        mScanColumns.clear();
+        mColumnsOfRow(r, mScanColumns);
+        for (int c : mScanColumns)
+        {
+            Flip(mCovered, c);
+            if (!Test(mOptional, c))
+                ++mRemaining;
+        }
+    }
+
+    // Pick the uncovered required column with the fewest compatible rows and store those rows in the level.
+    // Counting a column stops as soon as it cannot beat the best one found so far. Returns false if some column
+    // cannot be covered at all.
+    bool ImplicitMatrixImp::MostConstrainedColumn(Level& level)
+    {
+        size_t best = numeric_limits<size_t>::max();
+        level.column = -1;
+        level.candidates.clear();
+        level.next = 0;
+        level.row = -1;
+
+        for (size_t w = 0; w < mCovered.size(); ++w)
+        {
+            uint64_t open = ~(mCovered[w] | mOptional[w]);
+            while (open)
+            {
+                int c = int(w * 64) + countr_zero(open);
+                open &= open - 1;
+                if (c >= mColumnCount)
+                    break;
+
+                mScanRows.clear();
+                mRowsOfColumn(c, mScanRows);
+
+                mCompatible.clear();
+                for (auto r : mScanRows)
+                    if (Compatible(r))
+                    {
+                        mCompatible.push_back(r);
+                        if (mCompatible.size() >= best)
+                            break;
+                    }
+
+                if (mCompatible.size() < best)
+                {
+                    best = mCompatible.size();
+                    level.column = c;
+                    swap(level.candidates, mCompatible);
+                    if (best == 0)
+                        return false;
+                    if (best == 1)
+                        return true;
+                }
+            }
+        }
+        return level.column >= 0;
+    }
+
+    void ImplicitMatrixImp::SolveImp(size_t depth, function<void(int64_t)>& tryRow, function<void(int64_t)>& undoRow, function<void()>& complete)
+    {
+        if (mRemaining == 0)
+        {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+            complete();
+            return;
+        }
+
+        if (mLevels.size() <= depth)
+        {
+            mLevels.resize(depth + 1);
+            UpdateMemoryMetric();
+        }
+        // Note that the level cannot be held by reference across the recursive call as mLevels may grow
+        if (!MostConstrainedColumn(mLevels[depth]))
+            return;
+
+        for (size_t i = 0; i < mLevels[depth].candidates.size(); ++i)
+        {
+            int64_t r = mLevels[depth].candidates[i];
+            Cover(r);
+            tryRow(r);
+            SolverMetrics::Add(mMetrics.nodes, uint64_t(1));
+            SolverMetrics::Add(mMetrics.depth, 1);
+
+            SolveImp(depth + 1, tryRow, undoRow, complete);
+
+            SolverMetrics::Add(mMetrics.depth, -1);
+            undoRow(r);
+            Uncover(r);
+        }
+    }
+
+    void ImplicitMatrixImp::Solve(function<void(int64_t)> tryRow, function<void(int64_t)> undoRow, function<void()> complete)
+    {
+        ValidateState(solving);
+        for (auto p : mSolutionPrefix)
+            tryRow(p);
+        SolveImp(0, tryRow, undoRow, complete);
+        state = options;
+    }
+
+    // Iterative version for the same reason as in SparseMatrixImp: yielding from nested generators is expensive.
+    experimental::generator<const vector<int64_t>> ImplicitMatrixImp::Solve()
+    {
+        ValidateState(solving);
+
+        vector<int64_t> solution = mSolutionPrefix;
+
+        if (mRemaining == 0)
+        {
+            SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+            co_yield solution;
+        }
+        else
+        {
+            size_t depth = 0;
+            if (mLevels.empty())
+                mLevels.resize(1);
+
+            if (MostConstrainedColumn(mLevels[0]))
+            {
+                depth = 1;
+                while (depth > 0)
+                {
+                    Level& level = mLevels[depth - 1];
+
+                    // Undo the row tried last on this level
+                    if (level.row >= 0)
+                    {
+                        SolverMetrics::Add(mMetrics.depth, -1);
+                        Uncover(level.row);
+                        solution.pop_back();
+                        level.row = -1;
+                    }
+
+                    if (level.next == level.candidates.size())
+                    {
+                        --depth;
+                        continue;
+                    }
+
+                    level.row = level.candidates[level.next++];
+                    Cover(level.row);
+                    solution.push_back(level.row);
+                    SolverMetrics::Add(mMetrics.nodes, uint64_t(1));
+                    SolverMetrics::Add(mMetrics.depth, 1);
+
+                    if (mRemaining == 0)
+                    {
+                        SolverMetrics::Add(mMetrics.solutions, uint64_t(1));
+                        co_yield solution;
+                    }
+                    else
+                    {
+                        if (mLevels.size() <= depth)
+                        {
+                            mLevels.resize(depth + 1);
+                            UpdateMemoryMetric();
+                        }
+                        // A dead end leaves an empty level that is popped right away
+                        MostConstrainedColumn(mLevels[depth]);
+                        ++depth;
+                    }
+                }
+            }
+        }
+        state = options;
+    }
+}
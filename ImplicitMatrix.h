@@ -0,0 +1,46 @@
+// ImplicitMatrix.h
+// Algorithm X over a matrix that is never materialized
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+#include <experimental/generator>
+
+#include "Metrics.h"
+
+namespace DancingLinks
+{
+    // Same problem as SparseMatrix but the rows are not stored. The user supplies two callbacks instead:
+    // one enumerates candidate rows of a column, the other enumerates the columns of a row. The solver keeps only
+    // the coverage state (one bit per column) and asks for rows on demand, so the number of rows can be far beyond
+    // what fits in memory. Rows are identified by 64-bit numbers chosen by the user.
+    // The trade-off is speed: every search node re-enumerates candidates through the callbacks instead of following
+    // links, so this is only worth it when the matrix cannot be built.
+    class ImplicitMatrix
+    {
+    protected:
+        virtual ~ImplicitMatrix() = default;
+
+    public:
+        // Fill the vector with all rows having a one in the given column
+        typedef std::function<void(int, std::vector<int64_t>&)> RowsOfColumn;
+        // Fill the vector with all columns of the given row
+        typedef std::function<void(int64_t, std::vector<int>&)> ColumnsOfRow;
+
+        // Columns are numbered [0, columnCount). The callbacks are called from the solving thread only.
+        static ImplicitMatrix* Create(int columnCount, RowsOfColumn rowsOfColumn, ColumnsOfRow columnsOfRow);
+        static void Destroy(ImplicitMatrix* ptr);
+
+        // Same meaning as for SparseMatrix
+        virtual void SetConditionOptional(int c) = 0;
+        virtual void PreselectRow(int64_t r) = 0;
+
+        virtual void Solve(std::function<void(int64_t)> tryRow, std::function<void(int64_t)> undoRow, std::function<void()> complete) = 0;
+        virtual std::experimental::generator<const std::vector<int64_t>> Solve() = 0;
+
+        virtual const SolverMetrics& Metrics() const = 0;
+    };
+}
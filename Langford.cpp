@@ -0,0 +1,40 @@
+// Langford.cpp
+// Langford pairing problems
+
+#include <assert.h>
+#include <vector>
+
+#include "Langford.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    ExactCoverProblem MakeLangford(int n, bool skipMirrors)
+    {
+        assert(n > 0);
+
+        ExactCoverProblem problem;
+        problem.columnCount = problem.primaryCount = 3 * n;
+        for (int k = 1; k <= n; ++k)
+        {
+            // The mirror image of slot i is 2n - 1 - i, for 1 it moves the pair from i to 2n - 3 - i
+            int lastSlot = skipMirrors && k == 1 ? n - 2 : 2 * n - k - 2;
+            for (int i = 0; i <= lastSlot; ++i)
+                problem.rows.push_back({ k - 1, n + i, n + i + k + 1 });
+        }
+        return problem;
+    }
+
+    vector<int> DecodeLangford(const ExactCoverProblem& problem, const vector<int>& solution)
+    {
+        int n = problem.columnCount / 3;
+        vector<int> sequence(2 * n, 0);
+        for (int r : solution)
+        {
+            auto& row = problem.rows[r];
+            sequence[row[1] - n] = sequence[row[2] - n] = row[0] + 1;
+        }
+        return sequence;
+    }
+}
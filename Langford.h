@@ -0,0 +1,22 @@
+// Langford.h
+// Langford pairing problems
+
+#pragma once
+
+#include <vector>
+
+#include "Problem.h"
+
+namespace DancingLinks
+{
+    // Arrange two copies of each number 1..n in 2n slots so that the copies of k have exactly k slots between them.
+    // Columns are the numbers [0, n) and the slots [n, 3n); the rows are listed by number, then by first slot.
+    // Every solution read backwards is a solution too. With skipMirrors the first 1 is kept in the left half so
+    // only one of each such pair is found (the two copies of 1 can never be placed symmetrically).
+    // Solutions exist for n = 0 or 3 mod 4: 1, 1, 26, 150, 17792, 108144, ... for n = 3, 4, 7, 8, 11, 12 without
+    // mirrors.
+    ExactCoverProblem MakeLangford(int n, bool skipMirrors = false);
+
+    // The 2n numbers of a solution
+    std::vector<int> DecodeLangford(const ExactCoverProblem& problem, const std::vector<int>& solution);
+}
@@ -0,0 +1,73 @@
+// LatinSquare.cpp
+// Latin squares, their transversals and orthogonal mates
+
+#include <assert.h>
+#include <vector>
+#include <cmath>
+
+#include "LatinSquare.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    static int Order(const vector<int>& square)
+    {
+        int n = (int)lround(sqrt((double)square.size()));
+        assert(n > 0 && n * n == (int)square.size());
+        return n;
+    }
+
+    vector<int> CyclicLatinSquare(int n)
+    {
+        vector<int> square(n * n);
+        for (int r = 0; r < n; ++r)
+            for (int c = 0; c < n; ++c)
+                square[r * n + c] = (r + c) % n;
+        return square;
+    }
+
+    ExactCoverProblem MakeLatinSquares(int n)
+    {
+        assert(n > 0);
+
+        ExactCoverProblem problem;
+        problem.columnCount = problem.primaryCount = 3 * n * n;
+        problem.rows.reserve(n * n * n);
+        for (int r = 0; r < n; ++r)
+            for (int c = 0; c < n; ++c)
+                for (int s = 0; s < n; ++s)
+                    problem.rows.push_back({ r * n + c, n * n + r * n + s, 2 * n * n + c * n + s });
+        return problem;
+    }
+
+    vector<int> DecodeLatinSquare(int n, const vector<int>& solution)
+    {
+        vector<int> square(n * n);
+        for (int row : solution)
+            square[row / n] = row % n;
+        return square;
+    }
+
+    ExactCoverProblem MakeTransversals(const vector<int>& square)
+    {
+        int n = Order(square);
+
+        ExactCoverProblem problem;
+        problem.columnCount = problem.primaryCount = 3 * n;
+        for (int r = 0; r < n; ++r)
+            for (int c = 0; c < n; ++c)
+                problem.rows.push_back({ r, n + c, 2 * n + square[r * n + c] });
+        return problem;
+    }
+
+    ExactCoverProblem MakeOrthogonalMates(const vector<int>& square, const vector<vector<int>>& transversals)
+    {
+        int n = Order(square);
+
+        ExactCoverProblem problem;
+        problem.columnCount = problem.primaryCount = n * n;
+        problem.rows = transversals;
+        return problem;
+    }
+}
@@ -0,0 +1,29 @@
+// LatinSquare.h
+// Latin squares, their transversals and orthogonal mates
+
+#pragma once
+
+#include <vector>
+
+#include "Problem.h"
+
+namespace DancingLinks
+{
+    // Squares are stored row by row, symbol of cell (r, c) is square[r * n + c] in [0, n)
+    std::vector<int> CyclicLatinSquare(int n);
+
+    // All Latin squares of order n: 1, 2, 12, 576, 161280, ... Row (r * n + c) * n + s puts symbol s at row r,
+    // column c; columns are the cells, then row/symbol and column/symbol pairs.
+    ExactCoverProblem MakeLatinSquares(int n);
+    std::vector<int> DecodeLatinSquare(int n, const std::vector<int>& solution);
+
+    // Transversals of a square: n cells, one in every row and every column, with all symbols different. Row
+    // r * n + c is cell (r, c), so a solution is directly the list of the cells. The cyclic square has 15 of them for
+    // n = 5, 133 for n = 7 and none for even n.
+    ExactCoverProblem MakeTransversals(const std::vector<int>& square);
+
+    // Orthogonal mates: a mate takes the same symbol on every cell of a transversal, so mates are partitions of the
+    // cells into n disjoint transversals. Rows are the given transversals (e.g. all of them, decoded from the above),
+    // columns the cells. Every solution gives n! mates by naming the transversals with symbols.
+    ExactCoverProblem MakeOrthogonalMates(const std::vector<int>& square, const std::vector<std::vector<int>>& transversals);
+}
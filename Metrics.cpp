@@ -0,0 +1,138 @@
+// Metrics.cpp
+// Prometheus text exporter for the solver counters
+
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+
+#include "Metrics.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    string FormatPrometheus(const SolverMetrics& metrics, double nodesPerSecond)
+    {
+        char buffer[1024];
+        snprintf(buffer, sizeof(buffer),
+            "# HELP dlx_nodes_total Rows tried by the search.\n"
+            "# TYPE dlx_nodes_total counter\n"
+            "dlx_nodes_total %llu\n"
+            "# HELP dlx_nodes_per_second Search rate over the last export interval.\n"
+            "# TYPE dlx_nodes_per_second gauge\n"
+            "dlx_nodes_per_second %.1f\n"
+            "# HELP dlx_solutions_total Solutions found.\n"
+            "# TYPE dlx_solutions_total counter\n"
+            "dlx_solutions_total %llu\n"
+            "# HELP dlx_depth Current search depth.\n"
+            "# TYPE dlx_depth gauge\n"
+            "dlx_depth %d\n"
+            "# HELP dlx_memory_bytes Memory held by the sparse matrix.\n"
+            "# TYPE dlx_memory_bytes gauge\n"
+            "dlx_memory_bytes %llu\n",
+            (unsigned long long)metrics.nodes.load(memory_order_relaxed),
+            nodesPerSecond,
+            (unsigned long long)metrics.solutions.load(memory_order_relaxed),
+            metrics.depth.load(memory_order_relaxed),
+            (unsigned long long)metrics.memoryBytes.load(memory_order_relaxed));
+        return buffer;
+    }
+
+    class MetricsExporterImp final : public MetricsExporter
+    {
+    private:
+        const SolverMetrics& mMetrics;
+        filesystem::path mPath;
+        chrono::milliseconds mInterval;
+
+        // Previous sample for the rate calculation
+        uint64_t mLastNodes = 0;
+        chrono::steady_clock::time_point mLastTime;
+
+        mutex mLock;
+        condition_variable mWake;
+        bool mStop = false;
+        thread mThread;
+
+        void Run();
+        void Write();
+
+    public:
+        MetricsExporterImp(const SolverMetrics& metrics, const char* path, int intervalMs);
+        MetricsExporterImp(const MetricsExporterImp&) = delete;
+        MetricsExporterImp(MetricsExporterImp&&) = delete;
+        ~MetricsExporterImp();
+
+        virtual void Flush() override;
+    };
+
+    MetricsExporter* MetricsExporter::Create(const SolverMetrics& metrics, const char* path, int intervalMs)
+    {
+        return new MetricsExporterImp(metrics, path, intervalMs);
+    }
+
+    void MetricsExporter::Destroy(MetricsExporter* ptr)
+    {
+        delete ptr;
+    }
+
+    MetricsExporterImp::MetricsExporterImp(const SolverMetrics& metrics, const char* path, int intervalMs) :
+        mMetrics(metrics), mPath(path), mInterval(intervalMs)
+    {
+        mLastNodes = mMetrics.nodes.load(memory_order_relaxed);
+        mLastTime = chrono::steady_clock::now();
+        mThread = thread(&MetricsExporterImp::Run, this);
+    }
+
+    MetricsExporterImp::~MetricsExporterImp()
+    {
+        {
+            lock_guard<mutex> guard(mLock);
+            mStop = true;
+        }
+        mWake.notify_all();
+        mThread.join();
+        Write(); // final values
+    }
+
+    void MetricsExporterImp::Run()
+    {
+        unique_lock<mutex> guard(mLock);
+        while (!mWake.wait_for(guard, mInterval, [this] { return mStop; }))
+            Write();
+    }
+
+    void MetricsExporterImp::Flush()
+    {
+        lock_guard<mutex> guard(mLock);
+        Write();
+    }
+
+    // Always called with the lock held (or after the thread is gone)
+    void MetricsExporterImp::Write()
+    {
+        auto now = chrono::steady_clock::now();
+        uint64_t nodes = mMetrics.nodes.load(memory_order_relaxed);
+        double seconds = chrono::duration<double>(now - mLastTime).count();
+        double rate = seconds > 0 ? (nodes - mLastNodes) / seconds : 0.0;
+        mLastNodes = nodes;
+        mLastTime = now;
+
+        // Write to a temporary file and rename it over the target so readers never see a partial file
+        auto temp = mPath;
+        temp += ".tmp";
+        FILE* f = fopen(temp.string().c_str(), "w");
+        if (f == nullptr)
+            return;
+        string text = FormatPrometheus(mMetrics, rate);
+        fwrite(text.data(), 1, text.size(), f);
+        fclose(f);
+
+        error_code ec;
+        filesystem::rename(temp, mPath, ec);
+    }
+}
@@ -0,0 +1,49 @@
+// Metrics.h
+// Live solver counters for monitoring long-running solves
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace DancingLinks
+{
+    // Counters maintained by the solver while it runs. They are written by the solving thread only and may be read
+    // from any other thread at any time, so all accesses are relaxed atomics. The values are meant for dashboards,
+    // not for synchronization.
+    struct SolverMetrics
+    {
+        std::atomic<uint64_t> nodes{ 0 };        // rows tried so far (search tree nodes)
+        std::atomic<uint64_t> solutions{ 0 };    // solutions found so far
+        std::atomic<int> depth{ 0 };             // current search depth (not counting preselected rows)
+        std::atomic<size_t> memoryBytes{ 0 };    // memory held by the matrix
+
+        // Single writer increment. A plain load/store pair compiles to ordinary moves while fetch_add would
+        // be a locked instruction on every search node.
+        template<typename T> static void Add(std::atomic<T>& counter, T delta)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+    };
+
+    // Format the counters in Prometheus text exposition format. The rate is supplied by the caller as it
+    // requires two samples.
+    std::string FormatPrometheus(const SolverMetrics& metrics, double nodesPerSecond);
+
+    // Periodically writes the counters of a solver to a file in Prometheus text format (suitable for the
+    // node_exporter textfile collector). The file is replaced atomically on every update. The exporter
+    // runs its own thread; the metrics object must outlive it.
+    class MetricsExporter
+    {
+    public:
+        static MetricsExporter* Create(const SolverMetrics& metrics, const char* path, int intervalMs = 1000);
+        static void Destroy(MetricsExporter* ptr);
+
+        virtual ~MetricsExporter() = default;
+
+        // Write the current values immediately (e.g. once the solve is complete).
+        virtual void Flush() = 0;
+    };
+}
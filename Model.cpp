@@ -0,0 +1,148 @@
+// Model.cpp
+// Modeling layer: finite domain variables and simple constraints compiled to exact cover
+
+#include <assert.h>
+#include <vector>
+#include <algorithm>
+
+#include "Model.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    int Model::AddVariable(int domainSize)
+    {
+        assert(domainSize >= 0);
+        if (mDomainStart.empty())
+            mDomainStart.push_back(0);
+        mDomainStart.push_back(mDomainStart.back() + domainSize);
+        mForbidden.resize(mDomainStart.back(), 0);
+        return (int)mDomainStart.size() - 2;
+    }
+
+    int Model::LiteralIndex(Literal literal) const
+    {
+        assert(literal.variable >= 0 && literal.variable + 1 < (int)mDomainStart.size());
+        assert(literal.value >= 0 && mDomainStart[literal.variable] + literal.value < mDomainStart[literal.variable + 1]);
+        return mDomainStart[literal.variable] + literal.value;
+    }
+
+    void Model::Forbid(Literal literal)
+    {
+        mForbidden[LiteralIndex(literal)] = 1;
+    }
+
+    void Model::ExactlyOne(const vector<Literal>& literals)
+    {
+        mConstraints.push_back({ exactlyOne, 1, literals });
+    }
+
+    void Model::AtMostOne(const vector<Literal>& literals)
+    {
+        mConstraints.push_back({ atMostOne, 1, literals });
+    }
+
+    void Model::AllDifferent(const vector<int>& variables)
+    {
+        // One constraint per value that at least one of the variables can take
+        int values = 0;
+        for (int v : variables)
+            values = max(values, mDomainStart[v + 1] - mDomainStart[v]);
+
+        bool allUsed = true;
+        for (int v : variables)
+            allUsed = allUsed && mDomainStart[v + 1] - mDomainStart[v] == values;
+        allUsed = allUsed && (int)variables.size() == values;
+
+        for (int x = 0; x < values; ++x)
+        {
+            vector<Literal> literals;
+            for (int v : variables)
+                if (x < mDomainStart[v + 1] - mDomainStart[v])
+                    literals.push_back({ v, x });
+            mConstraints.push_back({ allUsed ? exactlyOne : atMostOne, 1, literals });
+        }
+    }
+
+    void Model::Capacity(const vector<Literal>& literals, int capacity)
+    {
+        assert(capacity >= 0);
+        if (capacity >= (int)literals.size())
+            return; // nothing to enforce
+
+        if (capacity == 0)
+        {
+            for (auto& literal : literals)
+                Forbid(literal);
+        }
+        else if (capacity == 1)
+        {
+            AtMostOne(literals);
+        }
+        else
+        {
+            mConstraints.push_back({ Kind::capacity, capacity, literals });
+        }
+    }
+
+    ExactCoverProblem Model::Compile()
+    {
+        int variableCount = max(0, (int)mDomainStart.size() - 1);
+        int literalCount = variableCount ? mDomainStart.back() : 0;
+
+        // Column numbers: variables, then the primary constraints, then the secondary ones
+        ExactCoverProblem problem;
+        vector<int> firstColumn(mConstraints.size());
+        int column = variableCount;
+        for (int k = 0; k < (int)mConstraints.size(); ++k)
+            if (mConstraints[k].kind == exactlyOne)
+                firstColumn[k] = column++;
+        problem.primaryCount = column;
+        for (int k = 0; k < (int)mConstraints.size(); ++k)
+            if (mConstraints[k].kind != exactlyOne)
+            {
+                firstColumn[k] = column++;
+                if (mConstraints[k].kind == Kind::capacity)
+                    problem.capacities.emplace_back(firstColumn[k], mConstraints[k].capacity);
+            }
+        problem.columnCount = column;
+
+        // Constraints of every literal, bucketed in one counting pass
+        vector<int> start(literalCount + 1, 0);
+        for (auto& constraint : mConstraints)
+            for (auto& literal : constraint.literals)
+                ++start[LiteralIndex(literal) + 1];
+        for (int l = 0; l < literalCount; ++l)
+            start[l + 1] += start[l];
+        vector<int> constraintsOf(start[literalCount]);
+        vector<int> fill(start.begin(), start.end() - 1);
+        for (int k = 0; k < (int)mConstraints.size(); ++k)
+            for (auto& literal : mConstraints[k].literals)
+                constraintsOf[fill[LiteralIndex(literal)]++] = k;
+
+        // One row per allowed literal
+        mRowLiterals.clear();
+        for (int v = 0; v < variableCount; ++v)
+            for (int l = mDomainStart[v]; l < mDomainStart[v + 1]; ++l)
+            {
+                if (mForbidden[l])
+                    continue;
+
+                problem.rows.emplace_back(1, v);
+                for (int i = start[l]; i < start[l + 1]; ++i)
+                    problem.rows.back().push_back(firstColumn[constraintsOf[i]]);
+                mRowLiterals.push_back({ v, l - mDomainStart[v] });
+            }
+
+        return problem;
+    }
+
+    vector<int> Model::Decode(const vector<int>& solution) const
+    {
+        vector<int> values(max(0, (int)mDomainStart.size() - 1), -1);
+        for (int r : solution)
+            values[mRowLiterals[r].variable] = mRowLiterals[r].value;
+        return values;
+    }
+}
@@ -0,0 +1,62 @@
+// Model.h
+// Modeling layer: finite domain variables and simple constraints compiled to exact cover
+
+#pragma once
+
+#include <vector>
+
+#include "Problem.h"
+
+namespace DancingLinks
+{
+    // Variable takes value
+    struct Literal
+    {
+        int variable;
+        int value;
+    };
+
+    // Every variable gets exactly one value from [0, domainSize), so every literal that is not forbidden is a row and
+    // every variable is a primary column. Constraints over literals become extra columns on those rows:
+    //  - ExactlyOne: primary column, AtMostOne: secondary column;
+    //  - AllDifferent: one column per value, primary if there are as many variables as values (every value is then
+    //    used exactly once), secondary otherwise;
+    //  - Capacity: at most k of the literals, a secondary column shared by up to k rows (see ExactCoverProblem).
+    // Literals within one constraint have to be distinct. Compile runs in time linear in the size of the result;
+    // the rows are ordered by variable, then value, one per literal.
+    class Model
+    {
+    public:
+        // Returns the variable number (they are numbered from 0)
+        int AddVariable(int domainSize);
+        void Forbid(Literal literal);
+
+        void ExactlyOne(const std::vector<Literal>& literals);
+        void AtMostOne(const std::vector<Literal>& literals);
+        void AllDifferent(const std::vector<int>& variables);
+        void Capacity(const std::vector<Literal>& literals, int capacity);
+
+        // The exact cover problem (load it with BuildMatrix from Problem.h). The model keeps track of what the rows
+        // mean so solutions can be decoded afterwards; compile again after adding more constraints.
+        ExactCoverProblem Compile();
+        // Value of every variable (-1 if the solution does not assign it)
+        std::vector<int> Decode(const std::vector<int>& solution) const;
+        Literal RowLiteral(int row) const { return mRowLiterals[row]; }
+
+    private:
+        enum Kind { exactlyOne, atMostOne, capacity };
+        struct Constraint
+        {
+            Kind kind;
+            int capacity;
+            std::vector<Literal> literals;
+        };
+
+        std::vector<int> mDomainStart;      // literal numbers: variable v, value x is mDomainStart[v] + x
+        std::vector<char> mForbidden;       // per literal
+        std::vector<Constraint> mConstraints;
+        std::vector<Literal> mRowLiterals;  // filled by Compile
+
+        int LiteralIndex(Literal literal) const;
+    };
+}
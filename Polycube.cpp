@@ -0,0 +1,241 @@
+// Polycube.cpp
+// Placement generator for 3D polycube packing puzzles
+
+#include <assert.h>
+#include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+
+#include "Polycube.h"
+#include "Bitboard.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    // Signed permutation of the axes: coordinate i of the result is sign[i] * coordinate axis[i] of the source
+    struct Transform
+    {
+        int axis[3];
+        int sign[3];
+        bool proper; // rotation (determinant +1) rather than a reflection
+
+        array<int, 3> Apply(const array<int, 3>& v) const
+        {
+            return { sign[0] * v[axis[0]], sign[1] * v[axis[1]], sign[2] * v[axis[2]] };
+        }
+    };
+
+    // All 48 symmetries of the cube, the 24 rotations first
+    static vector<Transform> CubeSymmetries()
+    {
+        vector<Transform> rotations, reflections;
+        int axis[3] = { 0, 1, 2 };
+        do
+        {
+            // Parity of the permutation
+            int inversions = (axis[0] > axis[1]) + (axis[0] > axis[2]) + (axis[1] > axis[2]);
+            for (int signs = 0; signs < 8; ++signs)
+            {
+                Transform t;
+                int det = inversions % 2 ? -1 : 1;
+                for (int i = 0; i < 3; ++i)
+                {
+                    t.axis[i] = axis[i];
+                    t.sign[i] = signs & (1 << i) ? -1 : 1;
+                    det *= t.sign[i];
+                }
+                t.proper = det > 0;
+                (t.proper ? rotations : reflections).push_back(t);
+            }
+        } while (next_permutation(axis, axis + 3));
+
+        rotations.insert(rotations.end(), reflections.begin(), reflections.end());
+        return rotations;
+    }
+
+    static VoxelList Normalize(VoxelList voxels)
+    {
+        array<int, 3> low = voxels[0];
+        for (auto& v : voxels)
+            for (int i = 0; i < 3; ++i)
+                low[i] = min(low[i], v[i]);
+        for (auto& v : voxels)
+            for (int i = 0; i < 3; ++i)
+                v[i] -= low[i];
+        sort(voxels.begin(), voxels.end());
+        return voxels;
+    }
+
+    Polycube MakePolycube(char name, const vector<vector<string>>& layers)
+    {
+        Polycube piece;
+        piece.name = name;
+        for (int z = 0; z < (int)layers.size(); ++z)
+            for (int y = 0; y < (int)layers[z].size(); ++y)
+                for (int x = 0; x < (int)layers[z][y].size(); ++x)
+                    if (layers[z][y][x] != ' ' && layers[z][y][x] != '.')
+                        piece.voxels.push_back({ x, y, z });
+        return piece;
+    }
+
+    vector<VoxelList> Orientations(const VoxelList& voxels, bool reflections)
+    {
+        vector<VoxelList> result;
+        if (voxels.empty())
+            return result;
+
+        for (auto& t : CubeSymmetries())
+        {
+            if (!t.proper && !reflections)
+                break;
+            VoxelList image;
+            for (auto& v : voxels)
+                image.push_back(t.Apply(v));
+            result.push_back(Normalize(image));
+        }
+
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    template<int Words>
+    static void Generate(const vector<Polycube>& pieces, const PolycubeBox& box, const PolycubeOptions& options, PolycubePlacements& set)
+    {
+        int sizeX = box.sizeX, sizeY = box.sizeY, sizeZ = box.sizeZ;
+        auto index = [sizeY, sizeZ](int x, int y, int z) { return (x * sizeY + y) * sizeZ + z; };
+
+        Bitboard<Words> mask;
+        VoxelList boxVoxels;
+        for (int x = 0; x < sizeX; ++x)
+            for (int y = 0; y < sizeY; ++y)
+                for (int z = 0; z < sizeZ; ++z)
+                    if (box.voxels.empty() || box.voxels[index(x, y, z)])
+                    {
+                        mask.Set(index(x, y, z));
+                        boxVoxels.push_back({ x, y, z });
+                    }
+
+        // Symmetries of the box as voxel permutations, only needed to restrict one piece
+        vector<vector<int>> symmetries;
+        if (options.restrictedPiece >= 0 && !boxVoxels.empty())
+        {
+            VoxelList normalBox = Normalize(boxVoxels);
+            // Images are moved back to the corner of the box voxels, which need not be the origin
+            array<int, 3> boxLow = boxVoxels[0];
+            for (auto& v : boxVoxels)
+                for (int i = 0; i < 3; ++i)
+                    boxLow[i] = min(boxLow[i], v[i]);
+            for (auto& t : CubeSymmetries())
+            {
+                if (!t.proper && !options.reflections)
+                    break;
+
+                VoxelList image;
+                for (auto& v : boxVoxels)
+                    image.push_back(t.Apply(v));
+                array<int, 3> low = image[0];
+                for (auto& v : image)
+                    for (int i = 0; i < 3; ++i)
+                        low[i] = min(low[i], v[i]);
+                if (Normalize(image) != normalBox)
+                    continue;
+
+                vector<int> permutation(sizeX * sizeY * sizeZ, -1);
+                for (auto& v : boxVoxels)
+                {
+                    auto w = t.Apply(v);
+                    permutation[index(v[0], v[1], v[2])] = index(w[0] - low[0] + boxLow[0], w[1] - low[1] + boxLow[1],
+                        w[2] - low[2] + boxLow[2]);
+                }
+                symmetries.push_back(permutation);
+            }
+        }
+
+        for (int p = 0; p < (int)pieces.size(); ++p)
+        {
+            for (int o = 0; o < (int)set.orientations[p].size(); ++o)
+            {
+                auto& shape = set.orientations[p][o];
+                int extent[3] = { 0, 0, 0 };
+                for (auto& v : shape)
+                    for (int i = 0; i < 3; ++i)
+                        extent[i] = max(extent[i], v[i] + 1);
+                if (extent[0] > sizeX || extent[1] > sizeY || extent[2] > sizeZ)
+                    continue;
+
+                Bitboard<Words> origin;
+                for (auto& v : shape)
+                    origin.Set(index(v[0], v[1], v[2]));
+
+                // Only shifts that keep the bounding box inside, so a shift never wraps into the next row or layer
+                for (int x = 0; x + extent[0] <= sizeX; ++x)
+                    for (int y = 0; y + extent[1] <= sizeY; ++y)
+                        for (int z = 0; z + extent[2] <= sizeZ; ++z)
+                        {
+                            auto placed = origin << index(x, y, z);
+                            if (!placed.Inside(mask))
+                                continue;
+
+                            // Keep only the smallest image of the restricted piece under the box symmetries
+                            if (p == options.restrictedPiece)
+                            {
+                                bool smallest = true;
+                                for (auto& permutation : symmetries)
+                                {
+                                    Bitboard<Words> image;
+                                    placed.ForEach([&](int v) { image.Set(permutation[v]); });
+                                    if (image < placed)
+                                    {
+                                        smallest = false;
+                                        break;
+                                    }
+                                }
+                                if (!smallest)
+                                    continue;
+                            }
+
+                            set.placements.push_back({ p, o, x, y, z });
+                            placed.ForEach([&set](int v) { set.columns.push_back(v); });
+                            set.columns.push_back(set.voxelCount + p);
+                            set.offsets.push_back(set.columns.size());
+                        }
+            }
+        }
+    }
+
+    PolycubePlacements GeneratePlacements(const vector<Polycube>& pieces, const PolycubeBox& box, const PolycubeOptions& options)
+    {
+        assert(box.sizeX > 0 && box.sizeY > 0 && box.sizeZ > 0);
+
+        PolycubePlacements set;
+        set.voxelCount = box.sizeX * box.sizeY * box.sizeZ;
+        assert(box.voxels.empty() || (int)box.voxels.size() == set.voxelCount);
+        set.offsets.push_back(0);
+        for (auto& piece : pieces)
+            set.orientations.push_back(Orientations(piece.voxels, options.reflections));
+
+        if (set.voxelCount <= 64)
+            Generate<1>(pieces, box, options, set);
+        else if (set.voxelCount <= 128)
+            Generate<2>(pieces, box, options, set);
+        else if (set.voxelCount <= 256)
+            Generate<4>(pieces, box, options, set);
+        else
+        {
+            assert(set.voxelCount <= 512);
+            Generate<8>(pieces, box, options, set);
+        }
+        return set;
+    }
+
+    void BuildMatrix(const PolycubePlacements& set, SparseMatrix* dlx)
+    {
+        dlx->BuildRows((int)set.placements.size(), [&set](int r, vector<int>& columns)
+            {
+                columns.assign(set.columns.begin() + set.offsets[r], set.columns.begin() + set.offsets[r + 1]);
+            });
+    }
+}
@@ -0,0 +1,69 @@
+// Polycube.h
+// Placement generator for 3D polycube packing puzzles (Soma, Bedlam, Tetris cube, ...)
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <array>
+
+#include "DancingLinks.h"
+
+namespace DancingLinks
+{
+    typedef std::vector<std::array<int, 3>> VoxelList; // (x, y, z)
+
+    struct Polycube
+    {
+        char name;
+        VoxelList voxels;
+    };
+
+    // Shape from a picture of layers, one picture per z level; any character other than ' ' and '.' is a voxel
+    Polycube MakePolycube(char name, const std::vector<std::vector<std::string>>& layers);
+
+    // All distinct orientations of a shape: the 24 rotations of the cube, and their mirror images if reflections
+    // are allowed, moved to the origin with voxels sorted
+    std::vector<VoxelList> Orientations(const VoxelList& voxels, bool reflections = false);
+
+    // The volume to fill: sizeX x sizeY x sizeZ with the voxels that belong to it, up to 512 voxels in the bounding
+    // box. Voxel (x, y, z) is number (x * sizeY + y) * sizeZ + z.
+    struct PolycubeBox
+    {
+        int sizeX = 0;
+        int sizeY = 0;
+        int sizeZ = 0;
+        std::vector<bool> voxels; // all voxels if empty
+    };
+
+    struct PolycubeOptions
+    {
+        bool reflections = false;
+        // Symmetry reduction: the placements of this piece are restricted to one per class under the symmetries of
+        // the box, so solutions that are rotations (reflections) of each other are mostly reported once. A solution
+        // can still repeat if the restricted piece sits in a position that some symmetry maps to itself. -1 disables.
+        int restrictedPiece = -1;
+    };
+
+    // Generated rows: voxel v is column v, piece p is column voxelCount + p. The columns of row r are
+    // columns[offsets[r], offsets[r + 1]).
+    struct PolycubePlacements
+    {
+        struct Placement
+        {
+            int piece;
+            int orientation;
+            int x, y, z;
+        };
+        std::vector<Placement> placements;
+        std::vector<std::vector<VoxelList>> orientations; // per piece
+        std::vector<size_t> offsets;
+        std::vector<int> columns;
+        int voxelCount = 0;
+    };
+
+    PolycubePlacements GeneratePlacements(const std::vector<Polycube>& pieces, const PolycubeBox& box, const PolycubeOptions& options = PolycubeOptions());
+
+    // Load the placements into an empty matrix (row numbers are placement indices)
+    void BuildMatrix(const PolycubePlacements& set, SparseMatrix* dlx);
+}
@@ -0,0 +1,192 @@
+// Polyomino.cpp
+// Placement generator for polyomino packing puzzles
+
+#include <assert.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "Polyomino.h"
+#include "Bitboard.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    Polyomino MakePolyomino(char name, const vector<string>& picture, bool unique)
+    {
+        Polyomino piece;
+        piece.name = name;
+        piece.unique = unique;
+        for (int y = 0; y < (int)picture.size(); ++y)
+            for (int x = 0; x < (int)picture[y].size(); ++x)
+                if (picture[y][x] != ' ' && picture[y][x] != '.')
+                    piece.cells.emplace_back(x, y);
+        return piece;
+    }
+
+    vector<Polyomino> Pentominoes()
+    {
+        return {
+            MakePolyomino('F', { ".XX", "XX.", ".X." }),
+            MakePolyomino('I', { "XXXXX" }),
+            MakePolyomino('L', { "XXXX", "X..." }),
+            MakePolyomino('P', { "XX", "XX", "X." }),
+            MakePolyomino('N', { ".XXX", "XX.." }),
+            MakePolyomino('T', { "XXX", ".X.", ".X." }),
+            MakePolyomino('U', { "X.X", "XXX" }),
+            MakePolyomino('V', { "X..", "X..", "XXX" }),
+            MakePolyomino('W', { "X..", "XX.", ".XX" }),
+            MakePolyomino('X', { ".X.", "XXX", ".X." }),
+            MakePolyomino('Y', { "XXXX", ".X.." }),
+            MakePolyomino('Z', { "XX.", ".X.", ".XX" }),
+        };
+    }
+
+    static CellList Normalize(CellList cells)
+    {
+        int minX = cells[0].first, minY = cells[0].second;
+        for (auto& c : cells)
+        {
+            minX = min(minX, c.first);
+            minY = min(minY, c.second);
+        }
+        for (auto& c : cells)
+        {
+            c.first -= minX;
+            c.second -= minY;
+        }
+        sort(cells.begin(), cells.end());
+        return cells;
+    }
+
+    vector<CellList> Orientations(const CellList& cells, bool reflections)
+    {
+        vector<CellList> result;
+        if (cells.empty())
+            return result;
+
+        CellList current = cells;
+        for (int mirror = 0; mirror < (reflections ? 2 : 1); ++mirror)
+        {
+            for (int rotation = 0; rotation < 4; ++rotation)
+            {
+                result.push_back(Normalize(current));
+                for (auto& c : current)
+                    c = { c.second, -c.first };
+            }
+            for (auto& c : current)
+                c.first = -c.first;
+        }
+
+        sort(result.begin(), result.end());
+        result.erase(unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+    template<int Words>
+    static void Generate(const vector<Polyomino>& pieces, const PolyominoBoard& board, PlacementSet& set)
+    {
+        int width = board.width, height = board.height;
+
+        Bitboard<Words> mask;
+        for (int i = 0; i < width * height; ++i)
+            if (board.cells.empty() || board.cells[i])
+                mask.Set(i);
+
+        int pieceColumn = 0;
+        for (int p = 0; p < (int)pieces.size(); ++p)
+        {
+            int column = pieces[p].unique ? width * height + pieceColumn++ : -1;
+
+            for (int o = 0; o < (int)set.orientations[p].size(); ++o)
+            {
+                auto& shape = set.orientations[p][o];
+                int sizeX = 0, sizeY = 0;
+                Bitboard<Words> origin;
+                for (auto& c : shape)
+                {
+                    sizeX = max(sizeX, c.first + 1);
+                    sizeY = max(sizeY, c.second + 1);
+                }
+                if (sizeX > width || sizeY > height)
+                    continue;
+                for (auto& c : shape)
+                    origin.Set(c.first * height + c.second);
+
+                // Only shifts that keep the bounding box on the board, so a shift never wraps into the next column
+                for (int x = 0; x + sizeX <= width; ++x)
+                    for (int y = 0; y + sizeY <= height; ++y)
+                    {
+                        auto placed = origin << (x * height + y);
+                        if (!placed.Inside(mask))
+                            continue;
+
+                        set.placements.push_back({ p, o, x, y });
+                        placed.ForEach([&set](int i) { set.columns.push_back(i); });
+                        if (column >= 0)
+                            set.columns.push_back(column);
+                        set.offsets.push_back(set.columns.size());
+                    }
+            }
+        }
+        set.pieceColumns = pieceColumn;
+    }
+
+    PlacementSet GeneratePlacements(const vector<Polyomino>& pieces, const PolyominoBoard& board, bool reflections)
+    {
+        assert(board.width > 0 && board.height > 0);
+        assert(board.cells.empty() || (int)board.cells.size() == board.width * board.height);
+
+        PlacementSet set;
+        set.width = board.width;
+        set.height = board.height;
+        set.offsets.push_back(0);
+        for (auto& piece : pieces)
+            set.orientations.push_back(Orientations(piece.cells, reflections));
+
+        int cells = board.width * board.height;
+        if (cells <= 64)
+            Generate<1>(pieces, board, set);
+        else if (cells <= 128)
+            Generate<2>(pieces, board, set);
+        else
+        {
+            assert(cells <= 256);
+            Generate<4>(pieces, board, set);
+        }
+        return set;
+    }
+
+    void BuildMatrix(const PlacementSet& set, SparseMatrix* dlx)
+    {
+        dlx->BuildRows((int)set.placements.size(), [&set](int r, vector<int>& columns)
+            {
+                columns.assign(set.columns.begin() + set.offsets[r], set.columns.begin() + set.offsets[r + 1]);
+            });
+    }
+
+    GridProblem MakeGridProblem(const PlacementSet& set)
+    {
+        GridProblem problem;
+        problem.width = set.width;
+        problem.height = set.height;
+        problem.pieceCount = set.pieceColumns;
+        problem.placements.reserve(set.placements.size());
+        for (size_t r = 0; r < set.placements.size(); ++r)
+            problem.placements.emplace_back(set.columns.begin() + set.offsets[r], set.columns.begin() + set.offsets[r + 1]);
+        return problem;
+    }
+
+    vector<string> Render(const PlacementSet& set, const vector<Polyomino>& pieces, const vector<int>& solution)
+    {
+        vector<string> picture(set.height, string(set.width, '.'));
+        for (int r : solution)
+        {
+            auto& placement = set.placements[r];
+            for (auto& c : set.orientations[placement.piece][placement.orientation])
+                picture[placement.y + c.second][placement.x + c.first] = pieces[placement.piece].name;
+        }
+        return picture;
+    }
+}
@@ -0,0 +1,76 @@
+// Polyomino.h
+// Placement generator for polyomino packing puzzles
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+
+#include "DancingLinks.h"
+#include "GridTiling.h"
+
+namespace DancingLinks
+{
+    typedef std::vector<std::pair<int, int>> CellList; // (x, y) pairs
+
+    struct Polyomino
+    {
+        char name;
+        CellList cells;
+        // A unique piece gets its own column so it is used exactly once. Otherwise the shape can be used any
+        // number of times (e.g. dominoes).
+        bool unique = true;
+    };
+
+    // Shape from a picture, any character other than ' ' and '.' is a cell: { ".XX", "XX.", ".X." } is the F pentomino
+    Polyomino MakePolyomino(char name, const std::vector<std::string>& picture, bool unique = true);
+
+    // The twelve pentominoes. All rotations and reflections (63 of them) are generated from these pictures.
+    std::vector<Polyomino> Pentominoes();
+
+    // All distinct orientations of a shape (four rotations, and their mirror images if reflections are allowed)
+    // moved to the origin, cells sorted
+    std::vector<CellList> Orientations(const CellList& cells, bool reflections = true);
+
+    // The area to fill: width x height with the cells that belong to the puzzle. Up to 256 cells in the
+    // bounding rectangle.
+    struct PolyominoBoard
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<bool> cells; // x * height + y, all cells if empty
+    };
+
+    // Generated rows. Cell (x, y) is column x * height + y (the same numbering as GridProblem), unique piece p
+    // is column width * height + p. Rows are stored compressed: the columns of row r are
+    // columns[offsets[r], offsets[r + 1]).
+    struct PlacementSet
+    {
+        struct Placement
+        {
+            int piece;
+            int orientation;
+            int x, y;
+        };
+        std::vector<Placement> placements;
+        std::vector<std::vector<CellList>> orientations; // per piece
+        std::vector<size_t> offsets;
+        std::vector<int> columns;
+        int width = 0;
+        int height = 0;
+        int pieceColumns = 0;
+    };
+
+    // Every orientation of every piece is shifted over the board as a bitboard and kept where it fits.
+    PlacementSet GeneratePlacements(const std::vector<Polyomino>& pieces, const PolyominoBoard& board, bool reflections = true);
+
+    // Load the placements into an empty matrix (row numbers are placement indices)
+    void BuildMatrix(const PlacementSet& set, SparseMatrix* dlx);
+
+    // The same rows as a GridProblem for the counters in GridTiling.h (the board has to be a full rectangle)
+    GridProblem MakeGridProblem(const PlacementSet& set);
+
+    // Picture of a solution, one string per board row with the piece names ('.' for empty cells)
+    std::vector<std::string> Render(const PlacementSet& set, const std::vector<Polyomino>& pieces, const std::vector<int>& solution);
+}
@@ -0,0 +1,96 @@
+// Problem.cpp
+// Loaders for exact cover problems
+
+#include <assert.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+
+#include "Problem.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    bool ReadDlx1(istream& in, ExactCoverProblem& problem)
+    {
+        problem = ExactCoverProblem();
+
+        unordered_map<string, int> index;
+        bool haveItems = false;
+        string line, token;
+        vector<int> row;
+
+        while (getline(in, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (!line.empty() && line[0] == '|')
+                continue;
+
+            istringstream tokens(line);
+            if (!haveItems)
+            {
+                bool secondary = false;
+                while (tokens >> token)
+                {
+                    if (token == "|")
+                    {
+                        secondary = true;
+                        continue;
+                    }
+                    if (!index.emplace(token, problem.columnCount).second)
+                        return false;
+                    problem.columnNames.push_back(token);
+                    ++problem.columnCount;
+                    if (!secondary)
+                        ++problem.primaryCount;
+                }
+                haveItems = problem.columnCount > 0;
+                continue;
+            }
+
+            row.clear();
+            while (tokens >> token)
+            {
+                auto it = index.find(token);
+                if (it == index.end() || find(row.begin(), row.end(), it->second) != row.end())
+                    return false;
+                row.push_back(it->second);
+            }
+            if (!row.empty())
+                problem.rows.push_back(row);
+        }
+
+        return haveItems;
+    }
+
+    bool BuildMatrix(const ExactCoverProblem& problem, SparseMatrix* dlx)
+    {
+        vector<char> used(problem.columnCount, 0);
+        for (auto& row : problem.rows)
+            for (int c : row)
+            {
+                assert(c >= 0 && c < problem.columnCount);
+                used[c] = 1;
+            }
+
+        dlx->BuildRows((int)problem.rows.size(), [&problem](int r, vector<int>& columns) { columns = problem.rows[r]; });
+        for (int c = problem.primaryCount; c < problem.columnCount; ++c)
+            if (used[c])
+                dlx->SetConditionOptional(c);
+        for (auto& capacity : problem.capacities)
+        {
+            assert(capacity.first >= problem.primaryCount && capacity.first < problem.columnCount);
+            if (used[capacity.first])
+                dlx->SetConditionCapacity(capacity.first, capacity.second);
+        }
+
+        for (int c = 0; c < problem.primaryCount; ++c)
+            if (!used[c])
+                return false;
+        return true;
+    }
+}
@@ -0,0 +1,22 @@
+// Problem.h
+// Loaders for exact cover problems
+
+#pragma once
+
+#include <istream>
+
+#include "DancingLinks.h"
+#include "ExactCoverProblem.h"
+
+namespace DancingLinks
+{
+    // Read Knuth's dlx1 format: lines starting with '|' are comments, the first other line lists the item names
+    // (primary items, then optionally '|' and secondary items), every following line is an option listing its items.
+    // Returns false on malformed input (unknown or repeated item).
+    bool ReadDlx1(std::istream& in, ExactCoverProblem& problem);
+
+    // Load the problem into an empty matrix in one bulk pass (row numbers are indices in problem.rows). Returns false
+    // if a primary column is not used by any row: the matrix does not know about such a column and would report
+    // solutions for a problem that has none.
+    bool BuildMatrix(const ExactCoverProblem& problem, SparseMatrix* dlx);
+}
@@ -0,0 +1,84 @@
+// Queens.cpp
+// Counting N queens solutions
+
+#include <assert.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "Queens.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    void BuildQueensMatrix(int n, SparseMatrix* dlx)
+    {
+        assert(n > 0);
+
+        // Position of every rank/file in the organ-pipe order: n = 8 gives 3, 4, 2, 5, 1, 6, 0, 7
+        vector<int> pipe(n);
+        for (int k = 0; k < n; ++k)
+            pipe[(n - 1) / 2 + (k % 2 ? (k + 1) / 2 : -(k / 2))] = k;
+
+        // Matrix columns are created in index order, so the index gives the order of the column list
+        dlx->BuildRows(n * n, [n, &pipe](int r, vector<int>& columns)
+            {
+                int row = r % n;
+                int col = r / n;
+                columns.push_back(2 * pipe[row]);
+                columns.push_back(2 * pipe[col] + 1);
+                columns.push_back(2 * n + row + col);
+                columns.push_back(4 * n - 1 + col - row + n - 1);
+            });
+
+        for (int d = 0; d < 2 * (2 * n - 1); ++d)
+            dlx->SetConditionOptional(2 * n + d);
+    }
+
+    uint64_t CountQueens(int n, int threads)
+    {
+        assert(n > 0);
+
+        // First rank queens on files [0, (n + 1) / 2), the row numbers are simply the files
+        int choices = (n + 1) / 2;
+        if (threads <= 0)
+            threads = max(1, (int)thread::hardware_concurrency());
+        threads = max(1, min(threads, choices));
+
+        atomic<int> next{ 0 };
+        vector<uint64_t> totals(threads, 0);
+        auto work = [&](int t)
+            {
+                SparseMatrix* dlx = SparseMatrix::Create();
+                BuildQueensMatrix(n, dlx);
+
+                // Files are handed out from the middle outwards
+                for (int k; (k = next++) < choices; )
+                {
+                    int file = choices - 1 - k;
+                    dlx->PreselectRow(file * n);
+                    uint64_t count = dlx->Count();
+                    dlx->UnselectRow(file * n);
+
+                    bool middle = n % 2 == 1 && file == n / 2;
+                    totals[t] += middle ? count : 2 * count;
+                }
+
+                SparseMatrix::Destroy(dlx);
+            };
+
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t)
+            pool.emplace_back(work, t);
+        work(0);
+        for (auto& th : pool)
+            th.join();
+
+        uint64_t total = 0;
+        for (auto count : totals)
+            total += count;
+        return total;
+    }
+}
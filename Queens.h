@@ -0,0 +1,22 @@
+// Queens.h
+// Counting N queens solutions
+
+#pragma once
+
+#include <cstdint>
+
+#include "DancingLinks.h"
+
+namespace DancingLinks
+{
+    // N queens matrix: row r is a queen on board row r % n, board column r / n (the same as in Test.cpp). Ranks and
+    // files are primary columns in organ-pipe order - the middle ones first, alternating outwards, ranks and files
+    // interleaved - so that ties in the column choice go to the middle of the board where the branching is smallest.
+    // Diagonals are secondary columns.
+    void BuildQueensMatrix(int n, SparseMatrix* dlx);
+
+    // Number of solutions. Only queens in the left half of the first rank are tried (each solution there has a
+    // mirror image on the right; for odd n the middle file counts once), the choices are shared between threads,
+    // each with its own matrix. threads <= 0 means one per core.
+    uint64_t CountQueens(int n, int threads = 0);
+}
@@ -0,0 +1,77 @@
+// Scenarios.cpp
+// Solving one matrix under many sets of assumptions
+
+#include <assert.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#include "Scenarios.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    // Apply the assumptions, count and take them back in reverse order
+    static void SolveScenario(SparseMatrix* dlx, const Scenario& scenario, const ScenarioOptions& options, ScenarioResult& result)
+    {
+        size_t selected = dlx->SelectedRows().size();
+        size_t excluded = 0;
+
+        result.status = dlx->PreselectRows(scenario.forced);
+        if (result.status != SelectStatus::conflict)
+        {
+            for (int r : scenario.excluded)
+            {
+                SelectStatus status = dlx->ExcludeRow(r);
+                if (status == SelectStatus::conflict)
+                {
+                    result.status = status;
+                    break;
+                }
+                ++excluded;
+                if (status == SelectStatus::infeasible)
+                    result.status = status;
+            }
+        }
+
+        if (result.status == SelectStatus::ok)
+            result.count = dlx->Count(options.limit, options.firstSolution ? &result.firstSolution : nullptr);
+
+        while (excluded > 0)
+            dlx->RestoreRow(scenario.excluded[--excluded]);
+        while (dlx->SelectedRows().size() > selected)
+            dlx->UnselectRow(dlx->SelectedRows().back());
+    }
+
+    vector<ScenarioResult> SolveScenarios(const SparseMatrix* base, const vector<Scenario>& scenarios, const ScenarioOptions& options)
+    {
+        assert(base != nullptr);
+
+        vector<ScenarioResult> results(scenarios.size());
+        int threads = options.threads;
+        if (threads <= 0)
+            threads = max(1, (int)thread::hardware_concurrency());
+        threads = max(1, min(threads, (int)scenarios.size()));
+
+        // Scenarios are handed out one at a time, they can differ a lot in cost
+        atomic<size_t> next{ 0 };
+        auto work = [&]()
+            {
+                SparseMatrix* dlx = base->Clone();
+                for (size_t k; (k = next++) < scenarios.size(); )
+                    SolveScenario(dlx, scenarios[k], options, results[k]);
+                SparseMatrix::Destroy(dlx);
+            };
+
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t)
+            pool.emplace_back(work);
+        work();
+        for (auto& th : pool)
+            th.join();
+
+        return results;
+    }
+}
@@ -0,0 +1,41 @@
+// Scenarios.h
+// Solving one matrix under many sets of assumptions
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "DancingLinks.h"
+
+namespace DancingLinks
+{
+    // One what-if case: rows that must be in the solution and rows that must not. Both are applied on top of what
+    // the base matrix already has preselected.
+    struct Scenario
+    {
+        std::vector<int> forced;
+        std::vector<int> excluded;
+    };
+
+    struct ScenarioOptions
+    {
+        int threads = 0;                // <= 0 means one per core
+        uint64_t limit = UINT64_MAX;    // counting stops there, e.g. 1 for feasibility or 2 for uniqueness
+        bool firstSolution = false;     // keep the first solution of every scenario
+    };
+
+    struct ScenarioResult
+    {
+        // conflict: the forced rows overlap (or force an excluded row); infeasible: some required column cannot
+        // be covered under the assumptions. Either way nothing is searched and count is 0.
+        SelectStatus status = SelectStatus::ok;
+        uint64_t count = 0;
+        std::vector<int> firstSolution;
+    };
+
+    // Results in the order of the scenarios. Every thread works on its own clone of the base matrix, taking
+    // scenarios from a shared counter and applying and undoing the assumptions in place; the base is not touched
+    // (it must not be solved or changed meanwhile).
+    std::vector<ScenarioResult> SolveScenarios(const SparseMatrix* base, const std::vector<Scenario>& scenarios, const ScenarioOptions& options = {});
+}
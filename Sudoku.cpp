@@ -0,0 +1,292 @@
+// Sudoku.cpp
+// Exact cover matrices for Sudoku of any size and its common variants
+
+#include <assert.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <limits>
+
+#include "Sudoku.h"
+
+using namespace std;
+
+namespace DancingLinks
+{
+    static const char sDigits[] = "123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    SudokuProblem MakeSudoku(int boxWidth, int boxHeight, bool diagonals)
+    {
+        assert(boxWidth > 0 && boxHeight > 0);
+
+        SudokuProblem problem;
+        problem.size = boxWidth * boxHeight;
+        problem.diagonals = diagonals;
+        problem.boxWidth = boxWidth;
+        problem.boxHeight = boxHeight;
+        problem.regions.resize(problem.size * problem.size);
+        // There are boxHeight boxes across and boxWidth boxes down
+        for (int r = 0; r < problem.size; ++r)
+            for (int c = 0; c < problem.size; ++c)
+                problem.regions[r * problem.size + c] = (r / boxHeight) * boxHeight + c / boxWidth;
+        return problem;
+    }
+
+    SudokuProblem MakeJigsawSudoku(const vector<string>& regions, bool diagonals)
+    {
+        SudokuProblem problem;
+        problem.size = (int)regions.size();
+        problem.diagonals = diagonals;
+
+        // Regions are numbered in order of appearance
+        string names;
+        for (auto& line : regions)
+        {
+            assert((int)line.size() == problem.size);
+            for (char ch : line)
+            {
+                size_t region = names.find(ch);
+                if (region == string::npos)
+                {
+                    region = names.size();
+                    names.push_back(ch);
+                }
+                problem.regions.push_back((int)region);
+            }
+        }
+
+        assert((int)names.size() == problem.size);
+        for (int g = 0; g < problem.size; ++g)
+            assert(count(problem.regions.begin(), problem.regions.end(), g) == problem.size);
+        return problem;
+    }
+
+    void BuildMatrix(const SudokuProblem& problem, SparseMatrix* dlx)
+    {
+        int size = problem.size;
+        int cells = size * size;
+        assert((int)problem.regions.size() == cells);
+
+        // Everything follows from the row number, no lookups needed. Threads only pay off for the giant grids, a
+        // 9x9 matrix is built long before they would start.
+        int threads = cells * size >= 65536 ? 0 : 1;
+        dlx->BuildRows(cells * size, [&problem, size, cells](int element, vector<int>& columns)
+            {
+                int cell = element / size;
+                int n = element % size;
+                int r = cell / size;
+                int c = cell % size;
+                columns.push_back(cell);
+                columns.push_back(cells + r * size + n);
+                columns.push_back(2 * cells + c * size + n);
+                columns.push_back(3 * cells + problem.regions[cell] * size + n);
+                if (problem.diagonals)
+                {
+                    if (r == c)
+                        columns.push_back(4 * cells + n);
+                    if (r + c == size - 1)
+                        columns.push_back(4 * cells + size + n);
+                }
+            }, threads);
+    }
+
+    SelectStatus SetGivens(const SudokuProblem& problem, const vector<int>& grid, SparseMatrix* dlx)
+    {
+        assert((int)grid.size() == problem.size * problem.size);
+        vector<int> rows;
+        for (int cell = 0; cell < (int)grid.size(); ++cell)
+            if (grid[cell] > 0)
+                rows.push_back(cell * problem.size + grid[cell] - 1);
+        return dlx->PreselectRows(rows);
+    }
+
+    // Random full grid: a few random non-conflicting clues usually leave plenty of solutions, the first one is taken.
+    // Otherwise try again with other clues. Clashing clues are rejected by the matrix itself.
+    static vector<int> RandomGrid(const SudokuProblem& problem, SparseMatrix* dlx, mt19937& random)
+    {
+        int size = problem.size;
+        int cells = size * size;
+        vector<int> grid(cells), solution, selected;
+        while (true)
+        {
+            fill(grid.begin(), grid.end(), 0);
+            for (int i = 0; i < size + 2; ++i)
+            {
+                int cell = random() % cells;
+                int n = random() % size + 1;
+                int r = SudokuRow(problem, cell / size, cell % size, n);
+                SelectStatus status = grid[cell] == 0 ? dlx->PreselectRows({ &r, 1 }) : SelectStatus::conflict;
+                if (status != SelectStatus::conflict)
+                {
+                    grid[cell] = n;
+                    selected.push_back(r);
+                }
+                if (status == SelectStatus::infeasible)
+                    break;
+            }
+
+            bool found = dlx->Count(1, &solution) > 0;
+            for (; !selected.empty(); selected.pop_back())
+                dlx->UnselectRow(selected.back());
+            if (found)
+                return DecodeSolution(problem, grid, solution);
+        }
+    }
+
+    // Remove clues from a full grid while the solution stays unique. The clues not looked at yet are preselected
+    // in reverse order with the ones kept on top, so checking a clue only takes back and reapplies the kept ones.
+    static SudokuPuzzle Minimize(const SudokuProblem& problem, SparseMatrix* dlx, const vector<int>& full, mt19937& random)
+    {
+        int size = problem.size;
+        int cells = size * size;
+        auto row = [&](int cell) { return SudokuRow(problem, cell / size, cell % size, full[cell]); };
+
+        vector<int> order(cells);
+        for (int cell = 0; cell < cells; ++cell)
+            order[cell] = cell;
+        shuffle(order.begin(), order.end(), random);
+        for (int i = cells - 1; i >= 0; --i)
+            dlx->PreselectRow(row(order[i]));
+
+        vector<int> kept;
+        for (int cell : order)
+        {
+            for (int i = (int)kept.size() - 1; i >= 0; --i)
+                dlx->UnselectRow(row(kept[i]));
+            dlx->UnselectRow(row(cell));
+            for (int k : kept)
+                dlx->PreselectRow(row(k));
+
+            if (dlx->Count(2) > 1)
+            {
+                dlx->PreselectRow(row(cell));
+                kept.push_back(cell);
+            }
+        }
+
+        SudokuPuzzle puzzle;
+        puzzle.givens.assign(cells, 0);
+        for (int k : kept)
+            puzzle.givens[k] = full[k];
+        puzzle.solution = full;
+
+        // Difficulty is measured on the final puzzle alone
+        uint64_t nodes = dlx->Metrics().nodes;
+        dlx->Count(2);
+        puzzle.nodes = dlx->Metrics().nodes - nodes;
+
+        for (int i = (int)kept.size() - 1; i >= 0; --i)
+            dlx->UnselectRow(row(kept[i]));
+        return puzzle;
+    }
+
+    vector<SudokuPuzzle> GeneratePuzzles(const SudokuProblem& problem, int count, const SudokuGeneratorOptions& options)
+    {
+        int threads = options.threads > 0 ? options.threads : max(1, (int)thread::hardware_concurrency());
+        threads = max(1, min(threads, count));
+
+        // Every thread has its own matrix and random sequence and makes an equal share of the puzzles, or as many
+        // as its share of the attempts gave
+        vector<vector<SudokuPuzzle>> results(threads);
+        auto work = [&](int t)
+            {
+                mt19937 random((uint32_t)(options.seed * 1000003 + t));
+                SparseMatrix* dlx = SparseMatrix::Create();
+                BuildMatrix(problem, dlx);
+
+                int target = int((long long)count * (t + 1) / threads) - int((long long)count * t / threads);
+                long long attempts = options.attempts > 0 ? (long long)options.attempts * target : numeric_limits<long long>::max();
+                for (long long attempt = 0; (int)results[t].size() < target && attempt < attempts; ++attempt)
+                {
+                    SudokuPuzzle puzzle = Minimize(problem, dlx, RandomGrid(problem, dlx, random), random);
+                    if ((options.minNodes == 0 || puzzle.nodes >= options.minNodes) &&
+                        (options.maxNodes == 0 || puzzle.nodes <= options.maxNodes))
+                        results[t].push_back(move(puzzle));
+                }
+
+                SparseMatrix::Destroy(dlx);
+            };
+
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t)
+            pool.emplace_back(work, t);
+        work(0);
+        for (auto& th : pool)
+            th.join();
+
+        vector<SudokuPuzzle> puzzles;
+        for (auto& part : results)
+            for (auto& puzzle : part)
+                puzzles.push_back(move(puzzle));
+        return puzzles;
+    }
+
+    vector<int> ParseSudoku(const SudokuProblem& problem, const string& text)
+    {
+        assert(problem.size < (int)sizeof(sDigits));
+
+        vector<int> grid;
+        for (char ch : text)
+        {
+            if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n')
+                continue;
+            if (ch == '.' || ch == '0')
+            {
+                grid.push_back(0);
+                continue;
+            }
+            const char* digit = find(sDigits, sDigits + problem.size, (char)toupper(ch));
+            assert(digit != sDigits + problem.size); // not a digit of this size
+            grid.push_back(int(digit - sDigits) + 1);
+        }
+        assert((int)grid.size() == problem.size * problem.size);
+        return grid;
+    }
+
+    vector<int> DecodeSolution(const SudokuProblem& problem, const vector<int>& givens, const vector<int>& solution)
+    {
+        vector<int> grid = givens;
+        grid.resize(problem.size * problem.size);
+        for (int element : solution)
+            grid[element / problem.size] = element % problem.size + 1;
+        return grid;
+    }
+
+    vector<string> Render(const SudokuProblem& problem, const vector<int>& grid)
+    {
+        int size = problem.size;
+        bool wide = size >= (int)sizeof(sDigits);
+
+        vector<string> picture;
+        string separator;
+        for (int r = 0; r < size; ++r)
+        {
+            string line;
+            for (int c = 0; c < size; ++c)
+            {
+                int n = grid[r * size + c];
+                string digit = n == 0 ? "." : wide ? to_string(n) : string(1, sDigits[n - 1]);
+                if (wide && digit.size() < 2)
+                    digit.insert(0, 1, ' ');
+                line += digit;
+                if (c + 1 < size)
+                    line += problem.boxWidth && (c + 1) % problem.boxWidth == 0 ? '|' : ' ';
+            }
+            picture.push_back(line);
+
+            if (problem.boxHeight && (r + 1) % problem.boxHeight == 0 && r + 1 < size)
+            {
+                if (separator.empty())
+                {
+                    separator = line;
+                    for (auto& ch : separator)
+                        ch = ch == '|' ? '+' : '-';
+                }
+                picture.push_back(separator);
+            }
+        }
+        return picture;
+    }
+}
@@ -0,0 +1,73 @@
+// Sudoku.h
+// Exact cover matrices for Sudoku of any size and its common variants
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "DancingLinks.h"
+
+namespace DancingLinks
+{
+    // A size x size grid (size = N * M for N x M boxes) filled with digits [1, size]. Every row, column and region
+    // has each digit once. Regions are the boxes unless given explicitly (jigsaw Sudoku), diagonal Sudoku also
+    // requires each digit once on both main diagonals.
+    struct SudokuProblem
+    {
+        int size = 0;
+        bool diagonals = false;
+        std::vector<int> regions; // region of cell r * size + c, every region has size cells
+        int boxWidth = 0;         // only used for rendering, 0 for jigsaw regions
+        int boxHeight = 0;
+    };
+
+    // Regular Sudoku with boxes boxWidth cells wide and boxHeight cells high: 3, 3 is the classic 9x9, 4, 4 is
+    // 16x16, 5, 5 is 25x25
+    SudokuProblem MakeSudoku(int boxWidth, int boxHeight, bool diagonals = false);
+    // Jigsaw Sudoku, one string per grid row with a character naming the region of every cell
+    SudokuProblem MakeJigsawSudoku(const std::vector<std::string>& regions, bool diagonals = false);
+
+    // Matrix row of digit n (1-based) at row r, column c (0-based)
+    inline int SudokuRow(const SudokuProblem& problem, int r, int c, int n) { return (r * problem.size + c) * problem.size + n - 1; }
+
+    // Load all size^3 candidate rows into an empty matrix in one pass. Columns: cells, then row/digit,
+    // column/digit, region/digit and finally the two diagonals.
+    void BuildMatrix(const SudokuProblem& problem, SparseMatrix* dlx);
+    // Preselect the given digits (0 for an empty cell). Givens that clash are reported as a conflict and not set.
+    SelectStatus SetGivens(const SudokuProblem& problem, const std::vector<int>& grid, SparseMatrix* dlx);
+
+    // Grid from a string of size * size digits, '1'-'9' then 'A'-'Z' for larger grids; '.' or '0' is an empty cell.
+    // Whitespace is ignored.
+    std::vector<int> ParseSudoku(const SudokuProblem& problem, const std::string& text);
+    // Grid filled from the givens and the rows of a solution
+    std::vector<int> DecodeSolution(const SudokuProblem& problem, const std::vector<int>& givens, const std::vector<int>& solution);
+    struct SudokuGeneratorOptions
+    {
+        int threads = 0; // one per core if <= 0
+        uint64_t seed = 1;
+        // Difficulty window: search nodes the solver needs to find the solution and prove it unique. Puzzles
+        // outside are thrown away and generated again, 0 means no limit.
+        uint64_t minNodes = 0;
+        uint64_t maxNodes = 0;
+        // Grids tried per requested puzzle before giving up on a window that is hard to hit, <= 0 means no limit
+        int attempts = 100;
+    };
+
+    struct SudokuPuzzle
+    {
+        std::vector<int> givens;
+        std::vector<int> solution;
+        uint64_t nodes;
+    };
+
+    // Minimal puzzles with a unique solution: a random full grid is found first, then clues are removed one by one
+    // in random order as long as the solution stays unique. No clue of the result can be removed. Every thread builds
+    // the matrix once; the clues are preselected and taken back for each check instead of rebuilding. Fewer than
+    // count puzzles are returned if the difficulty window throws away too many of them (see attempts).
+    std::vector<SudokuPuzzle> GeneratePuzzles(const SudokuProblem& problem, int count, const SudokuGeneratorOptions& options = SudokuGeneratorOptions());
+
+    // Picture of a grid, one string per line, with box separators for regular Sudoku
+    std::vector<std::string> Render(const SudokuProblem& problem, const std::vector<int>& grid);
+}
@@ -2,14 +2,34 @@
 // Dancing Links algorithm test and examples of use
 
 #include "DancingLinks.h"
+#include "DancingLinksC.h"
+#include "ConflictIndex.h"
+#include "ImplicitMatrix.h"
+#include "GridTiling.h"
+#include "Model.h"
+#include "Polyomino.h"
+#include "Polycube.h"
+#include "Queens.h"
+#include "Scenarios.h"
+#include "Sudoku.h"
 
 #include <stdio.h>
+#include <algorithm>
 
 using namespace DancingLinks;
 
 #define QUEENS 1
 #define SUDOKU 1
 #define PENTOMINO 1
+#define IMPLICIT 1
+#define GRID 1
+#define POLYCUBE 1
+#define MODEL 1
+#define C_INTERFACE 1
+#define SCENARIOS 1
+#define SET_COVER 1
+#define PARALLEL 1
+#define CONFLICT_INDEX 1
 
 int main()
 {
@@ -62,70 +82,62 @@ int main()
         }
 
         SparseMatrix::Destroy(dlx);
+
+        // The same matrix built in bulk: every row is known upfront, so a generator fills in the columns of each
+        // row (on several threads) instead of setting the conditions one by one
+        dlx = SparseMatrix::Create();
+        dlx->BuildRows(NUMBER_OF_QUEENS * NUMBER_OF_QUEENS, [](int r, std::vector<int>& columns)
+            {
+                int row = r % NUMBER_OF_QUEENS;
+                int col = r / NUMBER_OF_QUEENS;
+                columns.push_back(row);
+                columns.push_back(col + NUMBER_OF_QUEENS);
+                columns.push_back(col + row + 2 * NUMBER_OF_QUEENS);
+                columns.push_back(col - row + 5 * NUMBER_OF_QUEENS);
+            });
+        for (int i = 0; i < 2 * NUMBER_OF_QUEENS - 1; ++i)
+            dlx->SetConditionOptional(i + 2 * NUMBER_OF_QUEENS);
+        for (int i = -NUMBER_OF_QUEENS + 1; i < NUMBER_OF_QUEENS; ++i)
+            dlx->SetConditionOptional(i + 5 * NUMBER_OF_QUEENS);
+        printf("Built in bulk: %llu\n\r", (unsigned long long)dlx->Count());
+        SparseMatrix::Destroy(dlx);
+
+        // The same count through the specialized path (symmetry and threads, see Queens.h)
+        printf("Counted: %llu\n\r", (unsigned long long)CountQueens(NUMBER_OF_QUEENS));
     }
 #endif
 
 #if SUDOKU
     // Sudoku
     {
-        constexpr int CELL_START = 0;
-        constexpr int ROW_START = 81;
-        constexpr int COL_START = 162;
-        constexpr int SQUARE_START = 243;
-
+        // Every cell and every possible number on that cell is a row, a digit N at row R and column C is
+        // row R*81+C*9+N-1 (see Sudoku.h for the columns and for larger grids and variants)
+        SudokuProblem sudoku = MakeSudoku(3, 3);
         SparseMatrix* dlx = SparseMatrix::Create();
-        // Just run through every cell and every possible number on that cell. Each row, column,
-        // and square has to have every number. Each cell has to have exactly one number
-        // So, a digit N at row R and column C will form DLX row R*81+C*9+N-1 (R and C are 0-base).
-        // This is actually a naive implementation and can be significantly optimized. See:
-        // https://www.kth.se/social/files/58861771f276547fe1dbf8d1/HLaestanderMHarrysson_dkand14.pdf
-        for (int r = 0; r < 9; ++r)
-            for (int c = 0; c < 9; ++c)
-                for (int n = 0; n < 9; ++n)
-                {
-                    int element = r * 81 + c * 9 + n;
-                    int sq = (r / 3) * 3 + (c / 3);
-                    dlx->SetCondition(CELL_START + 9 * r + c, element);
-                    dlx->SetCondition(ROW_START + 9 * r + n, element);
-                    dlx->SetCondition(COL_START + 9 * c + n, element);
-                    dlx->SetCondition(SQUARE_START + 9 * sq + n, element);
-                }
+        BuildMatrix(sudoku, dlx);
 
         // No optional conditions in this case
 
         // Now preset the puzzle. Normally, these should be read from file or standard input, hardcoded here
         // Actual puzzle source: https://en.wikipedia.org/wiki/Sudoku
-#define SET(r, c, n) dlx->PreselectRow(r*81 + c*9 + n - 1);
-        SET(0, 0, 5); SET(0, 1, 3); SET(0, 4, 7);
-        SET(1, 0, 6); SET(1, 3, 1); SET(1, 4, 9); SET(1, 5, 5);
-        SET(2, 1, 9); SET(2, 2, 8); SET(2, 7, 6);
-        SET(3, 0, 8); SET(3, 4, 6); SET(3, 8, 3);
-        SET(4, 0, 4); SET(4, 3, 8); SET(4, 5, 3); SET(4, 8, 1);
-        SET(5, 0, 7); SET(5, 4, 2); SET(5, 8, 6);
-        SET(6, 1, 6); SET(6, 6, 2); SET(6, 7, 8);
-        SET(7, 3, 4); SET(7, 4, 1); SET(7, 5, 9); SET(7, 8, 5);
-        SET(8, 4, 8); SET(8, 7, 7); SET(8, 8, 9);
-#undef SET
-
-        int sol[9][9];
+        std::vector<int> givens = ParseSudoku(sudoku,
+            "53..7...."
+            "6..195..."
+            ".98....6."
+            "8...6...3"
+            "4..8.3..1"
+            "7...2...6"
+            ".6....28."
+            "...419..5"
+            "....8..79");
+        SetGivens(sudoku, givens, dlx);
 
         int counter = 0;
         for (auto s : dlx->Solve())
         {
-            for (int x : s)
-                sol[x / 81][(x/9) % 9] = x % 9 + 1;
-
             printf("Solution %d:\n\r\n\r", ++counter);
-            for (int i = 0; i < 9; ++i)
-            {
-                for (int j = 0; j < 9; ++j)
-                {
-                    printf("%d%c", sol[i][j], j == 2 || j == 5 ? '|' : ' ');
-                }
-                puts("");
-                if (i == 2 || i == 5)
-                    puts("-----+-----+-----");
-            }
+            for (auto& line : Render(sudoku, DecodeSolution(sudoku, givens, s)))
+                puts(line.c_str());
             puts("");
         }
 
@@ -136,129 +148,19 @@ int main()
 #if PENTOMINO
     // Pentominoes
     {
-        // The most tedious part here - to preset all pieces. With all rotations and symmetries
-        // there are 63 possible configurations. It may be more fun to generate all those programmatically
-        // (and it would be the only feasible way with higher order puzzles) but this is good enough for this
-        // test. The table below is modified from another project of mine, the data presentation is not ideal for this
-        // one but I did not want to reenter everything from the scratch.
-        struct PieceInfo
-        {
-            char type;
-            int coverage[5]; // bitfield for five rows started with current one
-        };
-        const PieceInfo pieceInfo[] =
-        {
-            { 'F', 0x18, 0x30, 0x10, 0x00, 0x00 },
-            { 'F', 0x08, 0x0e, 0x04, 0x00, 0x00 },
-            { 'F', 0x08, 0x0c, 0x18, 0x00, 0x00 },
-            { 'F', 0x08, 0x1c, 0x04, 0x00, 0x00 },
-            { 'F', 0x18, 0x0c, 0x08, 0x00, 0x00 },
-            { 'F', 0x08, 0x38, 0x10, 0x00, 0x00 },
-            { 'F', 0x08, 0x18, 0x0c, 0x00, 0x00 },
-            { 'F', 0x08, 0x1c, 0x10, 0x00, 0x00 },
-            { 'I', 0xf8, 0x00, 0x00, 0x00, 0x00 },
-            { 'I', 0x08, 0x08, 0x08, 0x08, 0x08 },
-            { 'L', 0x78, 0x40, 0x00, 0x00, 0x00 },
-            { 'L', 0x78, 0x08, 0x00, 0x00, 0x00 },
-            { 'L', 0x08, 0x08, 0x08, 0x18, 0x00 },
-            { 'L', 0x08, 0x08, 0x08, 0x0c, 0x00 },
-            { 'L', 0x08, 0x78, 0x00, 0x00, 0x00 },
-            { 'L', 0x08, 0x0f, 0x00, 0x00, 0x00 },
-            { 'L', 0x18, 0x10, 0x10, 0x10, 0x00 },
-            { 'L', 0x18, 0x08, 0x08, 0x08, 0x00 },
-            { 'P', 0x18, 0x18, 0x08, 0x00, 0x00 },
-            { 'P', 0x18, 0x18, 0x10, 0x00, 0x00 },
-            { 'P', 0x08, 0x18, 0x18, 0x00, 0x00 },
-            { 'P', 0x08, 0x0c, 0x0c, 0x00, 0x00 },
-            { 'P', 0x38, 0x18, 0x00, 0x00, 0x00 },
-            { 'P', 0x38, 0x30, 0x00, 0x00, 0x00 },
-            { 'P', 0x18, 0x1c, 0x00, 0x00, 0x00 },
-            { 'P', 0x18, 0x38, 0x00, 0x00, 0x00 },
-            { 'N', 0x18, 0x70, 0x00, 0x00, 0x00 },
-            { 'N', 0x18, 0x0e, 0x00, 0x00, 0x00 },
-            { 'N', 0x38, 0x60, 0x00, 0x00, 0x00 },
-            { 'N', 0x38, 0x0c, 0x00, 0x00, 0x00 },
-            { 'N', 0x08, 0x18, 0x10, 0x10, 0x00 },
-            { 'N', 0x08, 0x0c, 0x04, 0x04, 0x00 },
-            { 'N', 0x08, 0x08, 0x18, 0x10, 0x00 },
-            { 'N', 0x08, 0x08, 0x0c, 0x04, 0x00 },
-            { 'T', 0x38, 0x10, 0x10, 0x00, 0x00 },
-            { 'T', 0x08, 0x08, 0x1c, 0x00, 0x00 },
-            { 'T', 0x08, 0x0e, 0x08, 0x00, 0x00 },
-            { 'T', 0x08, 0x38, 0x08, 0x00, 0x00 },
-            { 'U', 0x28, 0x38, 0x00, 0x00, 0x00 },
-            { 'U', 0x38, 0x28, 0x00, 0x00, 0x00 },
-            { 'U', 0x18, 0x08, 0x18, 0x00, 0x00 },
-            { 'U', 0x18, 0x10, 0x18, 0x00, 0x00 },
-            { 'V', 0x38, 0x08, 0x08, 0x00, 0x00 },
-            { 'V', 0x38, 0x20, 0x20, 0x00, 0x00 },
-            { 'V', 0x08, 0x08, 0x0e, 0x00, 0x00 },
-            { 'V', 0x08, 0x08, 0x38, 0x00, 0x00 },
-            { 'W', 0x18, 0x30, 0x20, 0x00, 0x00 },
-            { 'W', 0x18, 0x0c, 0x04, 0x00, 0x00 },
-            { 'W', 0x08, 0x18, 0x30, 0x00, 0x00 },
-            { 'W', 0x08, 0x0c, 0x06, 0x00, 0x00 },
-            { 'X', 0x08, 0x1c, 0x08, 0x00, 0x00 },
-            { 'Y', 0x78, 0x10, 0x00, 0x00, 0x00 },
-            { 'Y', 0x78, 0x20, 0x00, 0x00, 0x00 },
-            { 'Y', 0x08, 0x3c, 0x00, 0x00, 0x00 },
-            { 'Y', 0x08, 0x1e, 0x00, 0x00, 0x00 },
-            { 'Y', 0x08, 0x18, 0x08, 0x08, 0x00 },
-            { 'Y', 0x08, 0x0c, 0x08, 0x08, 0x00 },
-            { 'Y', 0x08, 0x08, 0x18, 0x08, 0x00 },
-            { 'Y', 0x08, 0x08, 0x0c, 0x08, 0x00 },
-            { 'Z', 0x18, 0x10, 0x30, 0x00, 0x00 },
-            { 'Z', 0x18, 0x08, 0x0c, 0x00, 0x00 },
-            { 'Z', 0x08, 0x38, 0x20, 0x00, 0x00 },
-            { 'Z', 0x08, 0x0e, 0x02, 0x00, 0x00 },
-        };
-
         SparseMatrix* dlx = SparseMatrix::Create();
 
-        // The puzzle is traditional - 6x10 rectangle
-        // The code below can be fairly easily modified to solve any puzzle: just use field larger than 6x10, large
-        // enough to cover the entire puzzle, and check each piece against the puzzle cells instead of the field
-        // boundaries like below.
-        for (int piece = 0; piece < 63; ++piece)
-        {
-            // Convert 'coverage' fields into offsets. x can actually be negative but y is always positive.
-            struct point { int x, y; };
-            point offset[5];
-            int count = 0;
-            for(int r=0; r<5; ++r)
-                for(int off=0; off<8; ++off)
-                    if (pieceInfo[piece].coverage[r] & (1 << off))
-                    {
-                        offset[count].y = r;
-                        offset[count].x = off - 3; // 0x08 is considered (0,0)
-                        ++count;
-                    }
-
-            // Go through all 60 cells
-            for(int x = 0; x < 10; ++x)
-                for (int y = 0; y < 6; ++y)
-                {
-                    // Does the piece fit when placed on this cell?
-                    bool good = true;
-                    for(int off=0; off<5; ++off)
-                        if (x + offset[off].x >= 10 || x + offset[off].x < 0 || y + offset[off].y >= 6)
-                        {
-                            good = false;
-                            break;
-                        }
-
-                    // If it does, add constraints for five cells that this piece covers and the piece type so
-                    // each type will only be used once
-                    int pieceHere = piece * 60 + y * 10 + x;
-                    if (good)
-                    {
-                        for (int off = 0; off < 5; ++off)
-                            dlx->SetCondition((x + offset[off].x) * 10 + y + offset[off].y, pieceHere);
-
-                        dlx->SetCondition(4000 + pieceInfo[piece].type, pieceHere);
-                    }
-                }
-        }
+        // This is the longest test, publish the solver counters while it runs
+        MetricsExporter* exporter = MetricsExporter::Create(dlx->Metrics(), "dlx_metrics.prom");
+
+        // The puzzle is traditional - 6x10 rectangle. Any other shape can be solved by passing the board cells
+        // in PolyominoBoard::cells.
+        std::vector<Polyomino> pieces = Pentominoes();
+        PolyominoBoard board;
+        board.width = 10;
+        board.height = 6;
+        PlacementSet placements = GeneratePlacements(pieces, board);
+        BuildMatrix(placements, dlx);
 
         // No optional conditions in this case and no preselected pieces
 
@@ -266,38 +168,420 @@ int main()
         // Note that there are no provisions against symmetry here so each solution will appear four times (expect
         // to see 9356 solutions). The easiest trick to eliminate redundant solutions is to remove some transformations
         // for one of the pieces (like reducing symmetries for L from 8 to 2).
-        char sol[6][10];
-
         int counter = 0;
         for (auto s : dlx->Solve())
         {
-            for (int x : s)
-            {
-                for (int r = 0; r < 5; ++r)
-                    for (int off = 0; off < 8; ++off)
-                        if (pieceInfo[x/60].coverage[r] & (1 << off))
-                        {
-                            sol[(x / 10) % 6 + r][x % 10 + off - 3] = pieceInfo[x / 60].type;
-                        }
-
-                sol[(x / 10) % 6][x % 10] = pieceInfo[x / 60].type;
-            }
- 
             printf("Solution %d:\n\r\n\r", ++counter);
-            for (int i = 0; i < 6; ++i)
-            {
-                printf("%.10s", sol[i]);
-                puts("");
-            }
+            for (auto& line : Render(placements, pieces, s))
+                puts(line.c_str());
             puts("");
         }
 
+        MetricsExporter::Destroy(exporter);
+        printf("Search nodes: %llu\n\r", (unsigned long long)dlx->Metrics().nodes.load());
+
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if IMPLICIT
+    // The same queens problem solved without storing the matrix: rows and columns are computed on demand
+    {
+        // Should be 92 solutions
+        constexpr int N = 8;
+
+        // Columns: N rows, N columns, 2N-1 slash diagonals, 2N-1 backslash diagonals (last two groups optional).
+        // Row number is col * N + row as above.
+        auto rowsOfColumn = [](int c, std::vector<int64_t>& rows)
+            {
+                for (int row = 0; row < N; ++row)
+                    for (int col = 0; col < N; ++col)
+                        if (c == row || c == col + N || c == col + row + 2 * N || c == col - row + N - 1 + 4 * N - 1)
+                            rows.push_back(col * N + row);
+            };
+        auto columnsOfRow = [](int64_t r, std::vector<int>& columns)
+            {
+                int row = int(r % N), col = int(r / N);
+                columns.push_back(row);
+                columns.push_back(col + N);
+                columns.push_back(col + row + 2 * N);
+                columns.push_back(col - row + N - 1 + 4 * N - 1);
+            };
+
+        ImplicitMatrix* dlx = ImplicitMatrix::Create(6 * N - 2, rowsOfColumn, columnsOfRow);
+        for (int c = 2 * N; c < 6 * N - 2; ++c)
+            dlx->SetConditionOptional(c);
+
+        int counter = 0;
+        for (auto s : dlx->Solve())
+            ++counter;
+        printf("Implicit %d queens: %d solutions\n\r", N, counter);
+
+        ImplicitMatrix::Destroy(dlx);
+    }
+#endif
+
+#if GRID
+    // Counting pentomino tilings by splitting the board in halves
+    {
+        // 4x15 board with the same pieces, should count 1472 tilings both ways (the 6x10 board works as well but
+        // takes much longer with the plain search)
+        constexpr int WIDTH = 15;
+        constexpr int HEIGHT = 4;
+
+        PolyominoBoard board;
+        board.width = WIDTH;
+        board.height = HEIGHT;
+        GridProblem problem = MakeGridProblem(GeneratePlacements(Pentominoes(), board));
+
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(problem, dlx);
+        unsigned long long counter = 0;
+        dlx->Solve([](int) {}, [](int) {}, [&counter]() { ++counter; });
+        SparseMatrix::Destroy(dlx);
+
+        printf("Pentomino tilings: %llu (plain), %llu (split), %llu (sweep)\n\r", counter,
+            (unsigned long long)CountTilingsSplit(problem), (unsigned long long)CountTilingsSweep(problem));
+    }
+
+    // Domino tilings of 8xN strips, the sweep handles long boards easily. Should be 12988816 for 8x8.
+    {
+        constexpr int HEIGHT = 8;
+        for (int width = 2; width <= 16; width += 2)
+        {
+            GridProblem problem;
+            problem.width = width;
+            problem.height = HEIGHT;
+            for (int x = 0; x < width; ++x)
+                for (int y = 0; y < HEIGHT; ++y)
+                {
+                    if (x + 1 < width)
+                        problem.placements.push_back({ x * HEIGHT + y, (x + 1) * HEIGHT + y });
+                    if (y + 1 < HEIGHT)
+                        problem.placements.push_back({ x * HEIGHT + y, x * HEIGHT + y + 1 });
+                }
+            printf("Domino tilings of %dx%d: %llu\n\r", HEIGHT, width, (unsigned long long)CountTilingsSweep(problem));
+        }
+    }
+#endif
+
+#if POLYCUBE
+    // Soma cube: seven pieces filling a 3x3x3 box
+    {
+        // Pieces are not reflected (A and B are mirror images of each other). Without restrictions there are 11520
+        // solutions; restricting the L piece to one placement per rotation class of the box leaves 480, and those
+        // are 240 pairs of mirror images.
+        std::vector<Polycube> pieces = {
+            MakePolycube('V', { { "XX", "X." } }),
+            MakePolycube('L', { { "XXX", "X.." } }),
+            MakePolycube('T', { { "XXX", ".X." } }),
+            MakePolycube('Z', { { "XX.", ".XX" } }),
+            MakePolycube('A', { { "XX", "X." }, { "..", "X." } }),
+            MakePolycube('B', { { "XX", "X." }, { ".X", ".." } }),
+            MakePolycube('P', { { "XX", "X." }, { "X.", ".." } }),
+        };
+
+        PolycubeBox box;
+        box.sizeX = box.sizeY = box.sizeZ = 3;
+        for (int restricted : { -1, 1 })
+        {
+            PolycubeOptions options;
+            options.restrictedPiece = restricted;
+            PolycubePlacements set = GeneratePlacements(pieces, box, options);
+
+            SparseMatrix* dlx = SparseMatrix::Create();
+            BuildMatrix(set, dlx);
+            unsigned long long counter = 0;
+            dlx->Solve([](int) {}, [](int) {}, [&counter]() { ++counter; });
+            SparseMatrix::Destroy(dlx);
+
+            printf("Soma cube: %zu placements, %llu solutions\n\r", set.placements.size(), counter);
+        }
+
+        // The same 3x3x3 cube as the far corner of a 4x4x4 box: the restricted count has to stay 480
+        box.sizeX = box.sizeY = box.sizeZ = 4;
+        box.voxels.assign(64, false);
+        for (int x = 1; x < 4; ++x)
+            for (int y = 1; y < 4; ++y)
+                for (int z = 1; z < 4; ++z)
+                    box.voxels[(x * 4 + y) * 4 + z] = true;
+        PolycubeOptions options;
+        options.restrictedPiece = 1;
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(GeneratePlacements(pieces, box, options), dlx);
+        printf("Soma cube in the corner of a larger box: %llu solutions\n\r", (unsigned long long)dlx->Count());
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if MODEL
+    // Graph coloring through the modeling layer: the Petersen graph has 120 colorings with three colors
+    {
+        constexpr int COLORS = 3;
+        const int edges[][2] = { {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}, {0, 5}, {1, 6}, {2, 7}, {3, 8}, {4, 9},
+            {5, 7}, {7, 9}, {9, 6}, {6, 8}, {8, 5} };
+
+        Model model;
+        for (int v = 0; v < 10; ++v)
+            model.AddVariable(COLORS);
+        for (auto& edge : edges)
+            for (int color = 0; color < COLORS; ++color)
+                model.AtMostOne({ { edge[0], color }, { edge[1], color } });
+
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(model.Compile(), dlx);
+        printf("Petersen graph colorings: %llu\n\r", (unsigned long long)dlx->Count());
+        SparseMatrix::Destroy(dlx);
+    }
+
+    // Tiny timetable: six exams over two periods, at most three exams per period, exams sharing
+    // students (0-1, 1-2, 3-4) in different periods, exam 5 not in period 0: two timetables, each found once.
+    {
+        constexpr int PERIODS = 2;
+        constexpr int EXAMS = 6;
+        const int clashes[][2] = { {0, 1}, {1, 2}, {3, 4} };
+
+        Model model;
+        for (int e = 0; e < EXAMS; ++e)
+            model.AddVariable(PERIODS);
+        for (int p = 0; p < PERIODS; ++p)
+        {
+            std::vector<Literal> period;
+            for (int e = 0; e < EXAMS; ++e)
+                period.push_back({ e, p });
+            model.Capacity(period, 3);
+            for (auto& clash : clashes)
+                model.AtMostOne({ { clash[0], p }, { clash[1], p } });
+        }
+        model.Forbid({ 5, 0 });
+
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildMatrix(model.Compile(), dlx);
+        int timetables = 0;
+        for (auto s : dlx->Solve())
+        {
+            printf("Timetable:");
+            for (int period : model.Decode(s))
+                printf(" %d", period);
+            printf("\n\r");
+            ++timetables;
+        }
+        SparseMatrix::Destroy(dlx);
+        printf("Timetables: %d\n\r", timetables);
+    }
+#endif
+
+#if C_INTERFACE
+    // The C interface as another language would use it: 8 queens from compressed rows, solutions delivered in
+    // blocks of 10 into local buffers (92 solutions), then again stopping after the third block
+    {
+        constexpr int N = 8;
+        std::vector<size_t> offsets = { 0 };
+        std::vector<int> columns;
+        for (int r = 0; r < N * N; ++r)
+        {
+            int row = r % N, col = r / N;
+            columns.insert(columns.end(), { row, N + col, 2 * N + row + col, 5 * N + col - row });
+            offsets.push_back(columns.size());
+        }
+
+        dlx_matrix* matrix = dlx_create();
+        dlx_build_csr(matrix, N * N, offsets.data(), columns.data(), 0);
+        for (int c = 2 * N; c < 6 * N; ++c)
+            dlx_set_optional(matrix, c);
+
+        size_t solutionOffsets[11];
+        int rows[10 * N];
+        struct Progress
+        {
+            int blocks;
+            int stopAfter;
+        };
+        auto callback = [](void* context, size_t, const size_t*, const int*) -> int
+            {
+                Progress* progress = (Progress*)context;
+                return ++progress->blocks == progress->stopAfter;
+            };
+
+        Progress progress = { 0, 0 };
+        uint64_t count = 0;
+        int status = dlx_solve(matrix, solutionOffsets, 10, rows, 10 * N, callback, &progress, &count);
+        printf("C interface: %llu solutions in %d blocks (status %d)\n\r", (unsigned long long)count, progress.blocks, status);
+
+        progress = { 0, 3 };
+        status = dlx_solve(matrix, solutionOffsets, 10, rows, 10 * N, callback, &progress, &count);
+        printf("C interface: %llu solutions when stopped (status %d)\n\r", (unsigned long long)count, status);
+
+        // With a queen preselected in the corner (4 solutions) it is delivered once at the start of each solution
+        dlx_preselect(matrix, 0);
+        struct Delivered
+        {
+            size_t solutions;
+            bool correct;
+        };
+        auto check = [](void* context, size_t count, const size_t* offsets, const int* rows) -> int
+            {
+                Delivered* delivered = (Delivered*)context;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    delivered->correct = delivered->correct && offsets[i + 1] - offsets[i] == N && rows[offsets[i]] == 0 &&
+                        std::count(rows + offsets[i], rows + offsets[i + 1], 0) == 1;
+                    ++delivered->solutions;
+                }
+                return 0;
+            };
+        Delivered delivered = { 0, true };
+        status = dlx_solve(matrix, solutionOffsets, 10, rows, 10 * N, check, &delivered, &count);
+        printf("C interface: %zu solutions with a preselected queen, rows %s (status %d)\n\r", delivered.solutions,
+            delivered.correct ? "correct" : "wrong", status);
+
+        dlx_destroy(matrix);
+    }
+#endif
+
+#if SCENARIOS
+    // What-if sweep over 8 queens: the first rank queen on every file (92 solutions between them), the first rank
+    // queen not in the left half (46) and two queens on one rank (a conflict, status 1)
+    {
+        constexpr int N = 8;
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildQueensMatrix(N, dlx);
+
+        std::vector<Scenario> scenarios;
+        for (int file = 0; file < N; ++file)
+            scenarios.push_back({ { file * N }, {} });
+        scenarios.push_back({ {}, { 0, N, 2 * N, 3 * N } });
+        scenarios.push_back({ { 0, N }, {} });
+
+        auto results = SolveScenarios(dlx, scenarios);
+        uint64_t total = 0;
+        for (int file = 0; file < N; ++file)
+            total += results[file].count;
+        printf("Scenarios: %llu solutions over the first rank, %llu on the right half, status %d for two queens on a rank\n\r",
+            (unsigned long long)total, (unsigned long long)results[N].count, (int)results[N + 1].status);
+
+        // The base matrix is left as it was
+        printf("Scenarios: base matrix %llu solutions\n\r", (unsigned long long)dlx->Count());
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if SET_COVER
+    // Set cover: every square of the 8x8 board attacked or occupied by some queen. Rows are queens, columns squares
+    // to cover at least once; the fewest queens doing that are 5.
+    {
+        constexpr int N = 8;
+        SparseMatrix* dlx = SparseMatrix::Create();
+        dlx->BuildRows(N * N, [](int r, std::vector<int>& columns)
+            {
+                int x = r % N, y = r / N;
+                for (int c = 0; c < N * N; ++c)
+                {
+                    int u = c % N, v = c / N;
+                    if (u == x || v == y || u - v == x - y || u + v == x + y)
+                        columns.push_back(c);
+                }
+            });
+        for (int c = 0; c < N * N; ++c)
+            dlx->SetConditionAtLeastOnce(c);
 
+        std::vector<int> queens;
+        dlx->SolveMinimum(queens);
+        printf("Queens dominating the board: %zu\n\r", queens.size());
+        SparseMatrix::Destroy(dlx);
+    }
 
+    // A preselected row with only a capacity (1) and an at-least-once column (2) leaves both of them, so searching
+    // again finds the same two solutions
+    {
+        SparseMatrix* dlx = SparseMatrix::Create();
+        const int cells[][2] = { {0, 1}, {0, 2}, {1, 0}, {1, 2}, {2, 0}, {2, 1} };
+        for (auto& cell : cells)
+            dlx->SetCondition(cell[0], cell[1]);
+        dlx->SetConditionCapacity(1, 2);
+        dlx->SetConditionAtLeastOnce(2);
+        dlx->PreselectRow(0);
+        uint64_t first = dlx->Count();
+        uint64_t second = dlx->Count();
+        printf("Preselected row without exact columns: %s\n\r", first == 2 && second == 2 ? "correct" : "wrong");
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if PARALLEL
+    // 10 queens on four threads, in blocks of 5 so that subtrees finish ahead of their turn and wait: the
+    // solutions have to come in the same order as from the generator
+    {
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildQueensMatrix(10, dlx);
+
+        std::vector<int> sequential;
+        for (auto& s : dlx->Solve())
+            sequential.insert(sequential.end(), s.begin(), s.end());
+
+        std::vector<int> parallel;
+        size_t count = 0;
+        dlx->SolveParallel([&](const SolutionBlock& block)
+            {
+                parallel.insert(parallel.end(), block.rows.begin(), block.rows.end());
+                count += block.Count();
+            }, 4, 5);
+        printf("Parallel: %zu solutions, %s order\n\r", count, parallel == sequential ? "same" : "different");
+        SparseMatrix::Destroy(dlx);
+    }
+#endif
+
+#if CONFLICT_INDEX
+    // Squares of the 8x8 board still free for a queen with one in the corner (42) and another a knight's move away
+    // (25), checked against comparing the squares directly
+    {
+        constexpr int N = 8;
+        SparseMatrix* dlx = SparseMatrix::Create();
+        BuildQueensMatrix(N, dlx);
+        ConflictIndex* index = ConflictIndex::Create(dlx);
+
+        auto attacks = [](int a, int b)
+            {
+                int ax = a % N, ay = a / N, bx = b % N, by = b / N;
+                return ax == bx || ay == by || ax - ay == bx - by || ax + ay == bx + by;
+            };
+        std::vector<int> selection = { 0 };
+        std::vector<int> rows;
+        for (int next : { 2 * N + 1, -1 })
+        {
+            index->CompatibleRows(selection, rows);
+            std::vector<int> direct;
+            for (int r = 0; r < N * N; ++r)
+                if (std::none_of(selection.begin(), selection.end(), [&](int s) { return attacks(r, s); }))
+                    direct.push_back(r);
+            printf("Conflict index: %zu squares free after %zu queens, %s\n\r", rows.size(), selection.size(),
+                rows == direct ? "correct" : "wrong");
+            selection.push_back(next);
+        }
+
+        ConflictIndex::Destroy(index);
+        SparseMatrix::Destroy(dlx);
+    }
+
+    // Rows sharing only an at-least-once column (2) do not conflict: with row 0 selected rows 1 and 2 still fit
+    {
+        SparseMatrix* dlx = SparseMatrix::Create();
+        const int cells[][2] = { {0, 0}, {2, 0}, {1, 1}, {2, 1}, {1, 2} };
+        for (auto& cell : cells)
+            dlx->SetCondition(cell[0], cell[1]);
+        dlx->SetConditionAtLeastOnce(2);
+        ConflictIndex* index = ConflictIndex::Create(dlx);
+
+        std::vector<int> selection = { 0 };
+        std::vector<int> rows;
+        index->CompatibleRows(selection, rows);
+        printf("Conflict index: rows %s fit with row 0 despite a shared at-least-once column\n\r",
+            rows == std::vector<int>{ 1, 2 } && !index->Conflicts(0, 1) && index->Conflicts(1, 2) ? "1 and 2" : "wrong");
+
+        ConflictIndex::Destroy(index);
         SparseMatrix::Destroy(dlx);
     }
 #endif
 
     return 0;
 }
-
@@ -1,119 +1,94 @@
-// Port of the Python implementation of Dancing Links X in 30 lines to C++
+// TinyDLX example and benchmark
+// The example is the one from the "Algorithm X in 30 lines" page, the benchmark counts solutions of the same problem
+// with both TinyDLX and SparseMatrix. Usage: TinyDLX [problem.dlx]
 
-#include <vector>
-#include <set>
-#include <map>
+#include <stdio.h>
 #include <algorithm>
-#include <experimental/generator>
+#include <chrono>
+#include <fstream>
 
-using namespace std;
-
-// The implementation uses for-range quite a bit for brevity but in one occasion it needs to iterate the container in reverse.
-// Using trick from https://stackoverflow.com/questions/8542591/c11-reverse-range-based-for-loop to perform reverse for-range loops.
-// Note that this requires C++14.
-template <typename T> struct reversion_wrapper { T& iterable; };
-template <typename T> auto begin(reversion_wrapper<T> w) { return rbegin(w.iterable); }
-template <typename T> auto end(reversion_wrapper<T> w) { return rend(w.iterable); }
-template <typename T> reversion_wrapper<T> reverse(T&& iterable) { return { iterable }; }
-//
+#include "TinyDLX.h"
+#include "DancingLinks.h"
+#include "Problem.h"
+#include "LatinSquare.h"
 
-// Following the original implementation line by line
-typedef vector<int> tXin;
-typedef map<char, vector<int>> tY;
-typedef shared_ptr<set<char>> tRow;
-typedef map<int, tRow> tX;
-
-typedef vector<tRow> tCols;
-typedef vector<char> tSolution;
+using namespace std;
+using namespace DancingLinks;
 
-tCols select(tX& X, tY& Y, char r)
+int main(int argc, char* argv[])
 {
-    tCols cols;
-    for (auto j : Y[r])
     {
-        for (auto i : *X[j])
+        vector<int> X = { 1, 2, 3, 4, 5, 6, 7 };
+        TinyDLX<int, char>::OptionList Y = {
+            { 'A', {1, 4, 7} },
+            { 'B', {1, 4} },
+            { 'C', {4, 5, 7} },
+            { 'D', {3, 5, 6} },
+            { 'E', {2, 3, 6, 7} },
+            { 'F', {2, 7} }
+        };
+
+        TinyDLX<int, char> dlx(X, Y);
+        for (auto s : dlx.Solve())
         {
-            for (auto k : Y[i])
+            for (auto c : s)
             {
-                if (k != j)
-                    X[k]->erase(i);
+                printf("'%c' ", c);
             }
+            printf("\n");
         }
-        cols.push_back(X[j]);
-        X.erase(j);
-    }
-    return cols;
-}
 
-void deselect(tX& X, tY& Y, char r, tCols cols)
-{
-    for (auto j : reverse(Y[r]))
-    {
-        X[j] = cols.back();
-        cols.pop_back();
-        for (auto i : *X[j])
+        // Solve starts over even when the last enumeration was left part way: stopped at the solution and solved
+        // again, the same solution comes out (its options maybe listed in another order)
+        vector<char> first, again;
+        for (auto& s : dlx.Solve())
         {
-            for (auto k : Y[i])
-            {
-                if (k != j)
-                    X[k]->insert(i);
-            }
+            first = s;
+            break;
         }
+        for (auto& s : dlx.Solve())
+            again.insert(again.end(), s.begin(), s.end());
+        sort(first.begin(), first.end());
+        sort(again.begin(), again.end());
+        printf("Solved again after stopping: %s\n", again == first ? "same solution" : "different solution");
     }
-}
 
-experimental::generator<tSolution> solve(tX& X, tY& Y, tSolution& solution)
-{
-    if (X.empty())
+    // Both engines timed on the same problem: a dlx1 file if given on the command line, otherwise Latin squares of
+    // order 5 (161280 of them, see LatinSquare.h).
     {
-        co_yield solution;
-    }
-    else
-    {
-        auto c = min_element(X.begin(), X.end(), [](const auto& a, const auto& b) { return a.second->size() < b.second->size(); });
-        set<char> Xc = *c->second; // Note that it has to be a copy as X may (and will) be modified in the recursive call
-        for (auto r : Xc)
+        ExactCoverProblem problem;
+        if (argc > 1)
         {
-            solution.push_back(r);
-            auto cols = select(X, Y, r);
-            for (auto s : solve(X, Y, solution))
+            ifstream in(argv[1]);
+            if (!ReadDlx1(in, problem))
             {
-                co_yield s;
+                printf("Cannot read %s\n", argv[1]);
+                return 1;
             }
-            deselect(X, Y, r, cols);
-            solution.pop_back();
         }
-    }
-}
+        else
+        {
+            problem = MakeLatinSquares(5);
+        }
 
-int main()
-{
-    tXin Xin = { 1, 2, 3, 4, 5, 6, 7 };
-    tY Y = { 
-        { 'A', {1, 4, 7} },
-        { 'B', {1, 4} },
-        { 'C', {4, 5, 7} },
-        { 'D', {3, 5, 6} },
-        { 'E', {2, 3, 6, 7} },
-        { 'F', {2, 7} }
-    };
+        auto start = chrono::steady_clock::now();
+        TinyDLX<int, int> tiny(problem);
+        long long tinyCount = 0;
+        for ([[maybe_unused]] auto& s : tiny.Solve())
+            ++tinyCount;
+        double tinyTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    tX X;
-    for (auto j : Xin)
-    {
-        X[j] = make_shared<set<char>>();
-        for (auto i : Y)
-            if (find(i.second.begin(), i.second.end(), j) != i.second.end())
-                X[j]->insert(i.first);
-    }
+        start = chrono::steady_clock::now();
+        SparseMatrix* sparse = SparseMatrix::Create();
+        long long sparseCount = 0;
+        if (BuildMatrix(problem, sparse))
+            sparse->Solve([](int) {}, [](int) {}, [&sparseCount]() { ++sparseCount; });
+        SparseMatrix::Destroy(sparse);
+        double sparseTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-    tSolution solution;
-    for (auto s : solve(X, Y, solution))
-    {
-        for (auto c : s)
-        {
-            printf("'%c' ", c);
-        }
-        printf("\n");
+        printf("%zu rows, %d columns: TinyDLX %lld solutions in %.3fs, SparseMatrix %lld in %.3fs\n",
+            problem.rows.size(), problem.columnCount, tinyCount, tinyTime, sparseCount, sparseTime);
     }
-}
\ No newline at end of file
+
+    return 0;
+}
@@ -0,0 +1,304 @@
+// TinyDLX.h
+// Lightweight header only Algorithm X over flat arrays
+//
+// This started as a port of the "Algorithm X in 30 lines" Python implementation (see README) that kept items and
+// options in maps of sets. Here the same structure lives in a few flat vectors: every item owns a slice of one
+// shared array listing its active options. Removing an option from an item swaps it past the end of the slice and
+// shrinks it; as removals are undone in exactly the reverse order, restoring is just growing the slice back. The
+// search is iterative with an explicit stack and every change is recorded in an undo log, so backtracking replays the
+// log instead of walking the options again, yielding a solution does not pass through nested generators, and nothing
+// is allocated once the search starts. That makes it a practical choice for small problems.
+
+#pragma once
+
+#include <assert.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <experimental/generator>
+
+#include "ExactCoverProblem.h"
+
+namespace DancingLinks
+{
+    template<typename Item, typename Option>
+    class TinyDLX
+    {
+    public:
+        typedef std::vector<std::pair<Option, std::vector<Item>>> OptionList;
+
+        // All items have to be covered exactly once by the chosen options, secondary items at most once. Items are
+        // compared with operator<, options are only used to report solutions.
+        TinyDLX(const std::vector<Item>& items, const OptionList& options, const std::vector<Item>& secondaryItems = {});
+
+        // The same input as SparseMatrix takes (see ExactCoverProblem.h) except capacities, options are reported by
+        // row index. No lookups are needed in this case, the whole structure is built in linear time.
+        explicit TinyDLX(const ExactCoverProblem& problem) requires std::is_same_v<Item, int> && std::is_same_v<Option, int>;
+
+        std::experimental::generator<const std::vector<Option>> Solve();
+
+    private:
+        std::vector<Option> mOptionNames;
+
+        // A cell is one (option, item) pair, numbered option by option: option o owns cells
+        // [mOptionStart[o], mOptionStart[o + 1]).
+        std::vector<int> mOptionStart;
+        std::vector<int> mCellItem;
+        std::vector<int> mCellOption;
+
+        // Item k lists its active options (as cells) in mList[mItemStart[k], mItemStart[k] + mItemSize[k]).
+        // mListPos is the inverse: where each cell currently sits in mList.
+        std::vector<int> mItemStart;
+        std::vector<int> mItemSize;
+        std::vector<int> mList;
+        std::vector<int> mListPos;
+
+        // Items not covered yet, same swap trick: the first mActiveCount entries are active
+        std::vector<int> mActive;
+        std::vector<int> mActivePos;
+        int mActiveCount = 0;
+        // Secondary items are never in the active list, covering them only removes conflicting options
+        std::vector<char> mSecondary;
+
+        // Undo log: an item number for every option removed from that item, -1 for every deactivated item. Both
+        // kinds of changes are restored by growing the corresponding range back.
+        std::vector<int> mUndo;
+
+        // Search stack: the item being covered on each level and the position in its option list
+        struct Level
+        {
+            int item;
+            int next;       // next position in mList to try
+            int end;
+            size_t mark;        // undo log size before the item was covered
+            size_t optionMark;  // undo log size before the current option was applied
+        };
+        std::vector<Level> mStack;
+        std::vector<Option> mSolution;
+
+        void Index(int itemCount);
+        void Deactivate(int item);
+        void Remove(int cell);
+        void Cover(int item);
+        void Undo(size_t mark);
+        bool PushLevel();
+    };
+
+    template<typename Item, typename Option>
+    TinyDLX<Item, Option>::TinyDLX(const std::vector<Item>& items, const OptionList& options, const std::vector<Item>& secondaryItems)
+    {
+        // Items are looked up by binary search in a sorted copy, secondary ones are numbered after the primary
+        std::vector<std::pair<Item, int>> lookup;
+        lookup.reserve(items.size() + secondaryItems.size());
+        for (int k = 0; k < (int)items.size(); ++k)
+            lookup.emplace_back(items[k], k);
+        for (int k = 0; k < (int)secondaryItems.size(); ++k)
+            lookup.emplace_back(secondaryItems[k], (int)items.size() + k);
+        std::sort(lookup.begin(), lookup.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        int itemCount = (int)lookup.size();
+        mSecondary.assign(itemCount, 0);
+        std::fill(mSecondary.begin() + items.size(), mSecondary.end(), 1);
+
+        mOptionStart.push_back(0);
+        for (auto& option : options)
+        {
+            mOptionNames.push_back(option.first);
+            for (auto& item : option.second)
+            {
+                auto it = std::lower_bound(lookup.begin(), lookup.end(), item, [](const auto& a, const Item& b) { return a.first < b; });
+                assert(it != lookup.end() && !(item < it->first)); // unknown item
+                mCellItem.push_back(it->second);
+                mCellOption.push_back((int)mOptionNames.size() - 1);
+            }
+            mOptionStart.push_back((int)mCellItem.size());
+        }
+
+        Index(itemCount);
+    }
+
+    template<typename Item, typename Option>
+    TinyDLX<Item, Option>::TinyDLX(const ExactCoverProblem& problem) requires std::is_same_v<Item, int> && std::is_same_v<Option, int>
+    {
+        assert(problem.capacities.empty()); // every column is taken once here
+        mSecondary.assign(problem.columnCount, 0);
+        std::fill(mSecondary.begin() + problem.primaryCount, mSecondary.end(), 1);
+
+        mOptionStart.reserve(problem.rows.size() + 1);
+        mOptionStart.push_back(0);
+        for (int r = 0; r < (int)problem.rows.size(); ++r)
+        {
+            mOptionNames.push_back(r);
+            for (int c : problem.rows[r])
+            {
+                assert(c >= 0 && c < problem.columnCount);
+                mCellItem.push_back(c);
+                mCellOption.push_back(r);
+            }
+            mOptionStart.push_back((int)mCellItem.size());
+        }
+
+        Index(problem.columnCount);
+    }
+
+    // Build the per item lists (the inverse index) from the option cells
+    template<typename Item, typename Option>
+    void TinyDLX<Item, Option>::Index(int itemCount)
+    {
+        // Counting sort of the cells by item gives every item its slice
+        int cellCount = (int)mCellItem.size();
+        mItemStart.assign(itemCount + 1, 0);
+        for (int e = 0; e < cellCount; ++e)
+            ++mItemStart[mCellItem[e] + 1];
+        for (int k = 0; k < itemCount; ++k)
+            mItemStart[k + 1] += mItemStart[k];
+        mItemSize.assign(itemCount, 0);
+        mList.resize(cellCount);
+        mListPos.resize(cellCount);
+        for (int e = 0; e < cellCount; ++e)
+        {
+            int k = mCellItem[e];
+            int p = mItemStart[k] + mItemSize[k]++;
+            mList[p] = e;
+            mListPos[e] = p;
+        }
+
+        mActivePos.assign(itemCount, -1);
+        for (int k = 0; k < itemCount; ++k)
+            if (!mSecondary[k])
+            {
+                mActivePos[k] = (int)mActive.size();
+                mActive.push_back(k);
+            }
+        mActiveCount = (int)mActive.size();
+
+        // Every cell can be removed and every item deactivated at most once at any time, the depth is bounded by
+        // the item count. Reserving that upfront keeps the search free of allocations.
+        mUndo.reserve(cellCount + itemCount);
+        mStack.reserve(itemCount);
+        mSolution.reserve(itemCount);
+    }
+
+    template<typename Item, typename Option>
+    void TinyDLX<Item, Option>::Deactivate(int item)
+    {
+        int p = mActivePos[item];
+        int last = --mActiveCount;
+        std::swap(mActive[p], mActive[last]);
+        mActivePos[mActive[p]] = p;
+        mActivePos[item] = last;
+        mUndo.push_back(-1);
+    }
+
+    template<typename Item, typename Option>
+    void TinyDLX<Item, Option>::Remove(int cell)
+    {
+        int k = mCellItem[cell];
+        int p = mListPos[cell];
+        int last = mItemStart[k] + --mItemSize[k];
+        std::swap(mList[p], mList[last]);
+        mListPos[mList[p]] = p;
+        mListPos[cell] = last;
+        mUndo.push_back(k);
+    }
+
+    // Take the item out of the active list and remove all options conflicting with it from the other items
+    template<typename Item, typename Option>
+    void TinyDLX<Item, Option>::Cover(int item)
+    {
+        if (!mSecondary[item])
+            Deactivate(item);
+        for (int p = mItemStart[item]; p < mItemStart[item] + mItemSize[item]; ++p)
+        {
+            int cell = mList[p];
+            int option = mCellOption[cell];
+            for (int e = mOptionStart[option]; e < mOptionStart[option + 1]; ++e)
+                if (e != cell)
+                    Remove(e);
+        }
+    }
+
+    // Roll back everything recorded after the mark, last change first
+    template<typename Item, typename Option>
+    void TinyDLX<Item, Option>::Undo(size_t mark)
+    {
+        while (mUndo.size() > mark)
+        {
+            int k = mUndo.back();
+            mUndo.pop_back();
+            if (k >= 0)
+                ++mItemSize[k];
+            else
+                ++mActiveCount;
+        }
+    }
+
+    // Choose the item with the fewest options and cover it. The item is covered first so its own list stays untouched
+    // while the level goes over it. Returns false on a dead end (an item with no options left).
+    template<typename Item, typename Option>
+    bool TinyDLX<Item, Option>::PushLevel()
+    {
+        int c = *std::min_element(mActive.begin(), mActive.begin() + mActiveCount,
+            [this](int a, int b) { return mItemSize[a] < mItemSize[b]; });
+        if (mItemSize[c] == 0)
+            return false;
+
+        size_t mark = mUndo.size();
+        Cover(c);
+        mStack.push_back({ c, mItemStart[c], mItemStart[c] + mItemSize[c], mark, mUndo.size() });
+        return true;
+    }
+
+    template<typename Item, typename Option>
+    std::experimental::generator<const std::vector<Option>> TinyDLX<Item, Option>::Solve()
+    {
+        // An enumeration left part way keeps its covers in the log, they are rolled back before starting over
+        Undo(0);
+        mSolution.clear();
+        mStack.clear();
+
+        if (mActiveCount == 0)
+        {
+            co_yield mSolution;
+        }
+        else if (PushLevel())
+        {
+            while (!mStack.empty())
+            {
+                Level& level = mStack.back();
+
+                // Every level below the top has its option applied, the top one has it unless just pushed
+                if (mSolution.size() == mStack.size())
+                {
+                    Undo(level.optionMark);
+                    mSolution.pop_back();
+                }
+
+                if (level.next == level.end)
+                {
+                    Undo(level.mark);
+                    mStack.pop_back();
+                    continue;
+                }
+
+                int cell = mList[level.next++];
+                int option = mCellOption[cell];
+                mSolution.push_back(mOptionNames[option]);
+                for (int e = mOptionStart[option]; e < mOptionStart[option + 1]; ++e)
+                    if (e != cell)
+                        Cover(mCellItem[e]);
+
+                if (mActiveCount == 0)
+                {
+                    co_yield mSolution;
+                }
+                else
+                {
+                    // On a dead end nothing is pushed and the option is undone on the next pass
+                    PushLevel();
+                }
+            }
+        }
+    }
+}
@@ -1,2 +1,4 @@
-cl Test.cpp DancingLinks.cpp /std:c++latest /EHsc /O2 
-cl TinyDLX.cpp /std:c++latest /EHsc /O2 
+cl Test.cpp ConflictIndex.cpp DancingLinks.cpp DancingLinksC.cpp GridTiling.cpp ImplicitMatrix.cpp Metrics.cpp Model.cpp Polycube.cpp Polyomino.cpp Problem.cpp Queens.cpp Scenarios.cpp Sudoku.cpp /std:c++latest /EHsc /O2 
+cl TinyDLX.cpp DancingLinks.cpp LatinSquare.cpp Metrics.cpp Problem.cpp /std:c++latest /EHsc /O2 
+cl Benchmark.cpp ConflictIndex.cpp DancingLinks.cpp Langford.cpp LatinSquare.cpp Metrics.cpp Polyomino.cpp Problem.cpp Queens.cpp Scenarios.cpp Sudoku.cpp /std:c++latest /EHsc /O2 
+cl /LD DancingLinksC.cpp DancingLinks.cpp Metrics.cpp /DDLX_EXPORTS /Fe:dancinglinks.dll /std:c++latest /EHsc /O2 